@@ -7,20 +7,257 @@
 #include <limits>
 #include <chrono>
 #include <ctime>
-#include <regex> 
 #include <stdexcept>
 #include <cmath> // <<< FIX: Include for std::round
+#include <map>
+#include <unordered_map>
+#include <deque>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <functional>
+#include <unordered_set>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <future>
+#include <memory>
+#include <filesystem>
+#include <atomic>
+#include <iomanip>
+#include <list>
+#include <set>
+#include <type_traits>
+#include <cstring>
+#include <cerrno>
 
 // Platform-specific headers for hidden password input
 #ifdef _WIN32
 #include <conio.h> 
+#include <io.h>
+#include <fcntl.h>
 #else
 #include <termios.h> 
 #include <unistd.h>  
+#include <fcntl.h>
+#endif
+
+// Hardware CRC32C for GCC/Clang on x86-64; the instruction is only used after a CPU check.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <nmmintrin.h>
+#define GMS_HAVE_CRC32C_HW 1
+#else
+#define GMS_HAVE_CRC32C_HW 0
 #endif
 
 using namespace std;
 
+// =================================================================================
+// ||                           CONSOLE RENDERING                                 ||
+// =================================================================================
+// std::format-style formatting for C++17 builds: "{}" takes the next argument,
+// "{:spec}" accepts [[fill]align][width][.precision][f] with align one of
+// '<', '>' or '^', and "{{" / "}}" print literal braces. As with std::format,
+// numbers align right and everything else left by default.
+namespace Fmt {
+    struct Spec {
+        char fill = ' ';
+        char align = 0;
+        size_t width = 0;
+        int precision = -1;
+        bool fixedPoint = false;
+    };
+
+    inline Spec parseSpec(const string& text) {
+        Spec spec;
+        size_t i = 0;
+        auto isAlign = [](char ch) { return ch == '<' || ch == '>' || ch == '^'; };
+        if (text.size() >= 2 && isAlign(text[1])) {
+            spec.fill = text[0];
+            spec.align = text[1];
+            i = 2;
+        } else if (!text.empty() && isAlign(text[0])) {
+            spec.align = text[0];
+            i = 1;
+        }
+        while (i < text.size() && isdigit(static_cast<unsigned char>(text[i]))) spec.width = spec.width * 10 + (text[i++] - '0');
+        if (i < text.size() && text[i] == '.') {
+            spec.precision = 0;
+            while (++i < text.size() && isdigit(static_cast<unsigned char>(text[i]))) spec.precision = spec.precision * 10 + (text[i] - '0');
+        }
+        if (i < text.size() && text[i] == 'f') spec.fixedPoint = true;
+        return spec;
+    }
+
+    template <typename T>
+    string formatArg(const T& value, const Spec& spec) {
+        ostringstream os;
+        os << boolalpha;
+        if (spec.fixedPoint) os << fixed;
+        if (spec.precision >= 0) os << setprecision(spec.precision);
+        os << value;
+        string text = os.str();
+        if (text.size() >= spec.width) return text;
+
+        constexpr bool numeric = is_arithmetic<T>::value && !is_same<T, char>::value && !is_same<T, bool>::value;
+        char align = spec.align ? spec.align : (numeric ? '>' : '<');
+        size_t pad = spec.width - text.size();
+        if (align == '<') return text + string(pad, spec.fill);
+        if (align == '>') return string(pad, spec.fill) + text;
+        return string(pad / 2, spec.fill) + text + string(pad - pad / 2, spec.fill);
+    }
+
+    template <typename... Args>
+    string format(const string& pattern, const Args&... args) {
+        vector<function<string(const Spec&)>> formatters{[&args](const Spec& spec) { return formatArg(args, spec); }...};
+        string out;
+        out.reserve(pattern.size() + 16 * sizeof...(args));
+        size_t next = 0;
+        for (size_t i = 0; i < pattern.size(); i++) {
+            char ch = pattern[i];
+            if ((ch == '{' || ch == '}') && i + 1 < pattern.size() && pattern[i + 1] == ch) {
+                out += ch;
+                i++;
+            } else if (ch == '{') {
+                size_t close = pattern.find('}', i);
+                if (close == string::npos) throw invalid_argument("Fmt: unterminated '{' in \"" + pattern + "\"");
+                string field = pattern.substr(i + 1, close - i - 1);
+                size_t colon = field.find(':');
+                string index = field.substr(0, colon);
+                size_t argIndex = index.empty() ? next++ : static_cast<size_t>(stoul(index));
+                if (argIndex >= formatters.size()) throw invalid_argument("Fmt: missing argument in \"" + pattern + "\"");
+                out += formatters[argIndex](parseSpec(colon == string::npos ? "" : field.substr(colon + 1)));
+                i = close;
+            } else {
+                out += ch;
+            }
+        }
+        return out;
+    }
+}
+
+// Everything written to cout collects in one buffer and reaches the terminal
+// as a single write() when the stream is flushed. Because cin is tied to cout,
+// that happens right before the program waits for input, i.e. once per screen.
+// cerr is tied to cout as well, so a warning from a pool or flusher thread can
+// flush the buffer while the desk thread is still appending; the mutex keeps
+// those two from racing on `pending`.
+class ScreenBuffer : public streambuf {
+public:
+    struct Stats {
+        unsigned long long screens = 0; // flushes that had something to show
+        unsigned long long writes = 0;  // write() system calls issued
+        unsigned long long bytes = 0;
+    };
+
+private:
+    mutex lock;
+    string pending;
+    Stats stats;
+
+    bool writeAll() {
+        size_t offset = 0;
+        while (offset < pending.size()) {
+#ifdef _WIN32
+            int written = _write(1, pending.data() + offset, static_cast<unsigned>(pending.size() - offset));
+#else
+            ssize_t written = ::write(STDOUT_FILENO, pending.data() + offset, pending.size() - offset);
+#endif
+            stats.writes++;
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            offset += static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        lock_guard<mutex> guard(lock);
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) pending += traits_type::to_char_type(ch);
+        return traits_type::not_eof(ch);
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        lock_guard<mutex> guard(lock);
+        pending.append(s, static_cast<size_t>(n));
+        return n;
+    }
+
+    int sync() override {
+        lock_guard<mutex> guard(lock);
+        if (pending.empty()) return 0;
+        stats.screens++;
+        stats.bytes += pending.size();
+        bool ok = writeAll();
+        pending.clear();
+        return ok ? 0 : -1;
+    }
+
+public:
+    ScreenBuffer() { pending.reserve(1 << 16); }
+    const Stats& counters() const { return stats; }
+};
+
+namespace Console {
+    inline ScreenBuffer*& installedBuffer() {
+        static ScreenBuffer* buffer = nullptr;
+        return buffer;
+    }
+
+    // Set GMS_RENDER_STATS=1 to print the write() count per screen on exit.
+    inline void reportStats() {
+        const char* env = getenv("GMS_RENDER_STATS");
+        if (!env || string(env) != "1" || !installedBuffer()) return;
+        cout.flush();
+        const ScreenBuffer::Stats& s = installedBuffer()->counters();
+        cerr << Fmt::format("Render stats: {} screens, {} write() calls ({:.2f} per screen), {} bytes ({:.0f} per screen)\n",
+                            s.screens, s.writes, s.screens ? double(s.writes) / s.screens : 0.0, s.bytes,
+                            s.screens ? double(s.bytes) / s.screens : 0.0);
+    }
+
+    // Routes cout through a ScreenBuffer. The buffer is never freed so the final
+    // flush during static destruction still has somewhere to go.
+    inline void install() {
+        if (installedBuffer()) return;
+        ios::sync_with_stdio(false);
+        installedBuffer() = new ScreenBuffer();
+        cout.rdbuf(installedBuffer());
+        atexit([] {
+            reportStats();
+            cout.flush();
+        });
+    }
+
+    template <typename... Args>
+    void print(const string& pattern, const Args&... args) {
+        cout << Fmt::format(pattern, args...);
+    }
+
+    inline const string& rule() {
+        static const string line = string(80, '*') + "\n";
+        return line;
+    }
+
+    // The boxed title used at the top of every screen; `blankRows` pads the box.
+    inline string bannerText(const string& title, int blankRows = 0) {
+        static const string blank = "*" + string(78, ' ') + "*\n";
+        string text = rule();
+        for (int i = 0; i < blankRows; i++) text += blank;
+        text += "*" + Fmt::format("{:^78}", title) + "*\n";
+        for (int i = 0; i < blankRows; i++) text += blank;
+        return text + rule();
+    }
+
+    inline void banner(const string& title) { cout << '\n' << bannerText(title); }
+
+}
+// =================================================================================
+
 // =================================================================================
 // ||                   MODULAR INPUT VALIDATION & UTILITIES                      ||
 // =================================================================================
@@ -29,16 +266,26 @@ namespace InputUtils {
     // Gracefully handles EOF (Ctrl+D/Ctrl+Z) to prevent infinite loops on input failure.
     void handle_cin_eof() {
         if (cin.eof()) {
-            cout << "\n\nOperation cancelled by user (EOF detected). Exiting." << endl;
+            cout << "\n\nOperation cancelled by user (EOF detected). Exiting.\n";
             exit(0);
         }
     }
 
-    // Securely gets password input, hiding characters with '*'.
+    // Securely gets password input, hiding characters with '*'. Each echo is
+    // flushed on its own only when a person is typing at a terminal.
     string get_hidden_password(const string& prompt) {
         cout << prompt;
         string password = "";
         char c;
+    #ifdef _WIN32
+        const bool interactive = _isatty(_fileno(stdin)) != 0;
+    #else
+        const bool interactive = isatty(STDIN_FILENO) != 0;
+    #endif
+        auto echo = [interactive](const char* text) {
+            cout << text;
+            if (interactive) cout.flush();
+        };
 
     #ifdef _WIN32
         while ((c = _getch()) != '\r') { // '\r' is Enter
@@ -46,11 +293,11 @@ namespace InputUtils {
             if (c == '\b') { // Handle backspace
                 if (!password.empty()) {
                     password.pop_back();
-                    cout << "\b \b";
+                    echo("\b \b");
                 }
             } else {
                 password += c;
-                cout << '*';
+                echo("*");
             }
         }
     #else
@@ -65,16 +312,16 @@ namespace InputUtils {
             if (c == 127 || c == 8) { // Handle backspace
                 if (!password.empty()) {
                     password.pop_back();
-                    cout << "\b \b";
+                    echo("\b \b");
                 }
             } else {
                 password += c;
-                cout << '*';
+                echo("*");
             }
         }
         tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
     #endif
-        cout << endl;
+        cout << '\n';
         return password;
     }
 
@@ -94,7 +341,7 @@ namespace InputUtils {
                 if (value >= min && value <= max) {
                     return value;
                 } else {
-                    cout << "Error: Input must be between " << min << " and " << max << ". Please try again.\n";
+                    Console::print("Error: Input must be between {} and {}. Please try again.\n", min, max);
                 }
             } else {
                 cout << "Error: Invalid input. Please enter a valid number.\n";
@@ -122,17 +369,21 @@ namespace InputUtils {
         }
     }
 
+    // Returns why a contact number is invalid, or an empty string if it is
+    // exactly 10 digits. Shared by the prompts and the bulk importer.
+    string contact_error(const string& contact) {
+        if (contact.length() != 10) return "Contact number must be exactly 10 digits";
+        if (!all_of(contact.begin(), contact.end(), ::isdigit)) return "Contact number must contain only digits";
+        return "";
+    }
+
     // Validates a contact number to ensure it is exactly 10 digits.
     string get_contact_number(const string& prompt) {
         while (true) {
             string contact = get_non_empty_string(prompt);
-            if (contact.length() != 10) {
-                cout << "Error: Contact number must be exactly 10 digits.\n";
-            } else if (!all_of(contact.begin(), contact.end(), ::isdigit)) {
-                cout << "Error: Contact number must contain only digits.\n";
-            } else {
-                return contact;
-            }
+            string error = contact_error(contact);
+            if (error.empty()) return contact;
+            Console::print("Error: {}.\n", error);
         }
     }
 
@@ -151,811 +402,7033 @@ namespace InputUtils {
         }
     }
     
+    // Checks a "Day-HH:MM" schedule (day case-insensitive, 00:00-23:59) and
+    // capitalizes the day part for consistency. Hand-written rather than a
+    // std::regex so the bulk importer can call it on millions of rows.
+    bool normalize_schedule(string& schedule) {
+        static const char* const DAYS[] = {"mon", "tue", "wed", "thu", "fri", "sat", "sun"};
+        if (schedule.size() != 9 || schedule[3] != '-' || schedule[6] != ':') return false;
+        string day = schedule.substr(0, 3);
+        for (auto& ch : day) ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+        if (none_of(begin(DAYS), end(DAYS), [&day](const char* d) { return day == d; })) return false;
+        for (int i : {4, 5, 7, 8}) {
+            if (!isdigit(static_cast<unsigned char>(schedule[i]))) return false;
+        }
+        if ((schedule[4] - '0') * 10 + (schedule[5] - '0') > 23 || schedule[7] > '5') return false;
+        schedule[0] = static_cast<char>(toupper(static_cast<unsigned char>(day[0])));
+        schedule[1] = day[1];
+        schedule[2] = day[2];
+        return true;
+    }
+
     // Validates schedule format (e.g., "Mon-10:00")
     string get_valid_schedule(const string& prompt) {
-        // Regex for Day (case-insensitive) followed by HH:MM
-        const regex pattern("(Mon|Tue|Wed|Thu|Fri|Sat|Sun)-(0[0-9]|1[0-9]|2[0-3]):([0-5][0-9])", std::regex::icase);
         while (true) {
             string schedule = get_non_empty_string(prompt);
-            if (regex_match(schedule, pattern)) {
-                // Capitalize the day part for consistency
-                schedule[0] = toupper(schedule[0]);
-                schedule[1] = tolower(schedule[1]);
-                schedule[2] = tolower(schedule[2]);
-                return schedule;
-            } else {
-                cout << "Error: Invalid format. Please use Day-HH:MM (e.g., 'Mon-10:00' or 'Sat-14:30').\n";
-            }
+            if (normalize_schedule(schedule)) return schedule;
+            cout << "Error: Invalid format. Please use Day-HH:MM (e.g., 'Mon-10:00' or 'Sat-14:30').\n";
         }
     }
 }
 // =================================================================================
 
 
-struct Trainer {
-    int id;
-    string name;
-    string specialization;
-    string contact;
-    string password;
+// =================================================================================
+// ||                          SCHEDULE TIME ARITHMETIC                           ||
+// =================================================================================
+namespace ScheduleUtils {
 
-    Trainer() {}
-    Trainer(int _id, string _name, string _specialization, string _contact, string _password)
-        : id(_id), name(_name), specialization(_specialization), contact(_contact), password(_password) {}
+    const int MINUTES_PER_DAY = 24 * 60;
+    const int MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+    // Allowed class lengths, shared by every prompt and the CSV importer.
+    const int MIN_CLASS_MINUTES = 15;
+    const int MAX_CLASS_MINUTES = 240;
+    const vector<string> WEEK_DAYS = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
 
-    void updateProfile() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                               UPDATE TRAINER PROFILE                         *\n";
-        cout << "********************************************************************************\n";
-        name = InputUtils::get_non_empty_string("Enter new name: ");
-        specialization = InputUtils::get_non_empty_string("Enter new specialization: ");
-        contact = InputUtils::get_contact_number("Enter new contact (10 digits): ");
-        password = InputUtils::get_hidden_password("Enter new password: ");
-        cout << "Profile updated successfully!\n";
+    // Converts a "Day-HH:MM" schedule into minutes since Monday 00:00.
+    // Returns -1 if the string is not a valid schedule.
+    int toMinuteOfWeek(const string& schedule) {
+        if (schedule.size() != 9 || schedule[3] != '-' || schedule[6] != ':') return -1;
+        string day = schedule.substr(0, 3);
+        day[0] = toupper(day[0]);
+        day[1] = tolower(day[1]);
+        day[2] = tolower(day[2]);
+
+        auto dayIt = find(WEEK_DAYS.begin(), WEEK_DAYS.end(), day);
+        if (dayIt == WEEK_DAYS.end()) return -1;
+        for (int i : {4, 5, 7, 8}) {
+            if (!isdigit(static_cast<unsigned char>(schedule[i]))) return -1;
+        }
+
+        int hours = (schedule[4] - '0') * 10 + (schedule[5] - '0');
+        int minutes = (schedule[7] - '0') * 10 + (schedule[8] - '0');
+        if (hours > 23 || minutes > 59) return -1;
+
+        int dayIndex = static_cast<int>(dayIt - WEEK_DAYS.begin());
+        return dayIndex * MINUTES_PER_DAY + hours * 60 + minutes;
     }
 
-    string toString() const {
-        return to_string(id) + "," + name + "," + specialization + "," + contact + "," + password;
+    // Inverse of toMinuteOfWeek; wraps values outside a single week.
+    string fromMinuteOfWeek(int minuteOfWeek) {
+        minuteOfWeek = ((minuteOfWeek % MINUTES_PER_WEEK) + MINUTES_PER_WEEK) % MINUTES_PER_WEEK;
+        int dayIndex = minuteOfWeek / MINUTES_PER_DAY;
+        int minuteOfDay = minuteOfWeek % MINUTES_PER_DAY;
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%s-%02d:%02d", WEEK_DAYS[dayIndex].c_str(), minuteOfDay / 60, minuteOfDay % 60);
+        return buffer;
     }
 
-    static Trainer fromString(const string& line) {
-        Trainer t;
-        stringstream ss(line);
-        string item;
-        try {
-            getline(ss, item, ','); t.id = stoi(item);
-            getline(ss, t.name, ',');
-            getline(ss, t.specialization, ',');
-            getline(ss, t.contact, ',');
-            getline(ss, t.password, ',');
-        } catch (const invalid_argument& e) {
-            cerr << "Error parsing Trainer from string: " << line << endl;
-        }
-        return t;
+    tm toLocalTm(time_t tt) {
+        tm local_tm;
+    #ifdef _WIN32
+        localtime_s(&local_tm, &tt);
+    #else
+        localtime_r(&tt, &local_tm);
+    #endif
+        return local_tm;
     }
-};
 
-struct Trainee {
-    int id;
-    string name;
-    string contact;
-    string password;
-    string membership_package; // "Basic" or "Premium"
-    int membership_duration_months; // 3 or 6
-    string payment_status; // "Paid" or "Due"
-    float height_m; // in meters
-    float weight_kg; // in kg
+    // Number of local calendar days since 1970-01-01 (days-from-civil algorithm).
+    int64_t localDayNumber(time_t tt) {
+        tm t = toLocalTm(tt);
+        int64_t y = t.tm_year + 1900;
+        int64_t m = t.tm_mon + 1;
+        int64_t d = t.tm_mday;
+        y -= (m <= 2) ? 1 : 0;
+        int64_t era = (y >= 0 ? y : y - 399) / 400;
+        int64_t yoe = y - era * 400;
+        int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
 
-    Trainee() : height_m(0), weight_kg(0), membership_duration_months(0) {}
-    Trainee(int _id, string _name, string _contact, string _password, string package, int duration)
-        : id(_id), name(_name), contact(_contact), password(_password), 
-          membership_package(package), membership_duration_months(duration),
-          payment_status("Paid"), height_m(0), weight_kg(0) {}
+    // Local hours since 1970-01-01 00:00, consistent with localDayNumber.
+    int64_t localHourNumber(time_t tt) {
+        return localDayNumber(tt) * 24 + toLocalTm(tt).tm_hour;
+    }
 
-    float calculateBMI() {
-        if (height_m > 0 && weight_kg > 0) {
-            return weight_kg / (height_m * height_m);
-        }
-        return 0;
+    // Same wall-clock time, N calendar months later (mktime normalizes day overflow).
+    time_t addMonths(time_t tt, int months) {
+        tm t = toLocalTm(tt);
+        t.tm_mon += months;
+        t.tm_isdst = -1;
+        return mktime(&t);
     }
-    
-    void updateProfile() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                             UPDATE TRAINEE PROFILE                           *\n";
-        cout << "********************************************************************************\n";
-        name = InputUtils::get_non_empty_string("Enter new name: ");
-        contact = InputUtils::get_contact_number("Enter new contact (10 digits): ");
-        password = InputUtils::get_hidden_password("Enter new password: ");
-        cout << "Profile updated successfully!\n";
+
+    string formatDate(time_t tt) {
+        tm t = toLocalTm(tt);
+        char buffer[16];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%d", &t);
+        return buffer;
     }
 
-    string toString() const {
-        return to_string(id) + "," + name + "," + contact + "," + password + "," + 
-               membership_package + "," + to_string(membership_duration_months) + "," + payment_status + "," +
-               to_string(height_m) + "," + to_string(weight_kg);
+    // Day of week for a local day number, 0 = Mon ... 6 = Sun (1970-01-01 was a Thursday).
+    int weekDayIndex(int64_t dayNumber) {
+        return static_cast<int>(((dayNumber + 3) % 7 + 7) % 7);
     }
+}
+// =================================================================================
+// =================================================================================
+// ||                          DURABLE FILE REPLACEMENT                           ||
+// =================================================================================
+namespace FileUtils {
 
-    static Trainee fromString(const string& line) {
-        Trainee t;
-        stringstream ss(line);
-        string item;
-        try {
-            getline(ss, item, ','); t.id = stoi(item);
-            getline(ss, t.name, ',');
-            getline(ss, t.contact, ',');
-            getline(ss, t.password, ',');
-            getline(ss, t.membership_package, ',');
-            getline(ss, item, ','); t.membership_duration_months = stoi(item);
-            getline(ss, t.payment_status, ',');
-            getline(ss, item, ','); t.height_m = stof(item);
-            getline(ss, item, ','); t.weight_kg = stof(item);
-        } catch (const invalid_argument& e) {
-            cerr << "Error parsing Trainee from string: " << line << endl;
-        }
-        return t;
+    bool fileExists(const string& path) {
+        ifstream file(path);
+        return file.good();
     }
-};
 
-struct GymClass {
-    string className;
-    string schedule; // Format: "Day-HH:MM", e.g., "Mon-10:00"
-    string trainerName;
-    int capacity;
-    int enrolled;
-    vector<int> enrolledTraineeIds;
+    bool writeFile(const string& path, const string& content) {
+        ofstream file(path, ios::binary | ios::trunc);
+        if (!file) return false;
+        file.write(content.data(), content.size());
+        file.flush();
+        return file.good();
+    }
 
-    GymClass() : capacity(0), enrolled(0) {}
-    GymClass(string _className, string _schedule, string _trainerName, int _capacity)
-        : className(_className), schedule(_schedule), trainerName(_trainerName),
-          capacity(_capacity), enrolled(0) {}
+    // Flushes a file, or a directory's list of entries, to stable storage.
+    bool syncToDisk(const string& path, bool directory = false) {
+#ifdef _WIN32
+        if (directory) return true; // NTFS journals renames itself
+        int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+        if (fd < 0) return false;
+        bool ok = _commit(fd) == 0;
+        _close(fd);
+        return ok;
+#else
+        int fd = ::open(path.c_str(), directory ? (O_RDONLY | O_DIRECTORY) : O_RDONLY);
+        if (fd < 0) return false;
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+#endif
+    }
 
-    string toString() const {
-        string result = className + "," + schedule + "," + trainerName + "," + 
-                       to_string(capacity) + "," + to_string(enrolled) + ",";
-        for (size_t i = 0; i < enrolledTraineeIds.size(); i++) {
-            result += to_string(enrolledTraineeIds[i]);
-            if (i < enrolledTraineeIds.size() - 1) result += ";";
-        }
-        return result;
+    string directoryOf(const string& path) {
+        string dir = filesystem::path(path).parent_path().string();
+        return dir.empty() ? "." : dir;
     }
 
-    static GymClass fromString(const string& line) {
-        GymClass c;
-        stringstream ss(line);
-        string item;
-        try {
-            getline(ss, c.className, ',');
-            getline(ss, c.schedule, ',');
-            getline(ss, c.trainerName, ',');
-            getline(ss, item, ','); c.capacity = stoi(item);
-            getline(ss, item, ','); c.enrolled = stoi(item);
-            
-            getline(ss, item, ',');
-            if (!item.empty()) {
-                stringstream idStream(item);
-                string idStr;
-                while (getline(idStream, idStr, ';')) {
-                    if (!idStr.empty()) {
-                        c.enrolledTraineeIds.push_back(stoi(idStr));
-                    }
-                }
+    const string COMMIT_SUFFIX = ".commit";
+    const string COMMIT_HEADER = "# gms-commit v1";
+
+    bool renameOver(const string& from, const string& to) {
+        error_code ec;
+        filesystem::rename(from, to, ec); // replaces `to` in one step
+        return !ec;
+    }
+
+    // Replaces several files as one unit that survives a crash. Each new version
+    // is written and fsynced to a ".tmp" sibling. A set of more than one file
+    // then gets a journal naming its files ("<first file>.commit"); once the
+    // journal is on disk the set is committed, and each ".tmp" is renamed over
+    // its original. A crash before the journal leaves the old files; a crash
+    // after it is rolled forward by recoverInterruptedCommits on the next start.
+    // Another process reading the files mid-commit may still see a mix; this
+    // program only reads them at startup, after recovery. `committed` tells a
+    // failure before that point (old files kept) from one after it.
+    bool replaceFilesAtomically(const vector<pair<string, string>>& files, string& error, bool& committed) {
+        committed = false;
+        auto discardTemps = [&files]() {
+            for (const auto& f : files) remove((f.first + ".tmp").c_str());
+        };
+        for (const auto& f : files) {
+            if (!writeFile(f.first + ".tmp", f.second) || !syncToDisk(f.first + ".tmp")) {
+                discardTemps();
+                error = "could not write " + f.first + ".tmp; no file was changed";
+                return false;
             }
-        } catch (const invalid_argument& e) {
-             cerr << "Error parsing GymClass from string: " << line << endl;
         }
-        return c;
-    }
-};
 
-class GymManagement {
-private:
-    const string TRAINEE_FILE = "trainees.txt";
-    const string TRAINER_FILE = "trainers.txt";
-    const string CLASS_FILE = "classes.txt";
-    const string ADMIN_FILE = "admins.txt";
+        string directory = directoryOf(files[0].first);
+        string journal = files[0].first + COMMIT_SUFFIX;
+        if (files.size() > 1) {
+            string listing = COMMIT_HEADER + "\n";
+            for (const auto& f : files) listing += f.first + "\n";
+            if (!writeFile(journal + ".tmp", listing) || !syncToDisk(journal + ".tmp") ||
+                !renameOver(journal + ".tmp", journal) || !syncToDisk(directory, true)) {
+                remove((journal + ".tmp").c_str());
+                remove(journal.c_str());
+                discardTemps();
+                error = "could not record the commit for " + files[0].first + "; no file was changed";
+                return false;
+            }
+        }
 
-    int getCost(const string& package, int duration) {
-        if (package == "Basic") {
-            return (duration == 3) ? 100 : 180;
-        } else if (package == "Premium") {
-            return (duration == 3) ? 150 : 270;
+        // Committed: from here on a failure is finished by the next start.
+        committed = files.size() > 1;
+        for (const auto& f : files) {
+            if (!renameOver(f.first + ".tmp", f.first)) {
+                error = "could not replace " + f.first + (files.size() > 1 ? "; it will be completed on the next start" : "");
+                if (files.size() == 1) discardTemps();
+                return false;
+            }
         }
-        return 0;
+        syncToDisk(directory, true);
+        if (files.size() > 1) remove(journal.c_str());
+        committed = true;
+        return true;
     }
 
-public:
-    GymManagement() {
-        initializeAdminFile();
+    bool replaceFilesAtomically(const vector<pair<string, string>>& files, string& error) {
+        bool committed;
+        return replaceFilesAtomically(files, error, committed);
     }
 
-    void initializeAdminFile() {
-        ifstream file(ADMIN_FILE);
-        if (!file.good()) {
-            ofstream outFile(ADMIN_FILE);
-            outFile << "admin,admin123\n";
-            outFile.close();
+    // Run before a data directory is read. Finishes every set whose journal made
+    // it to disk and drops the leftovers of sets that never committed: ".tmp"
+    // files of `dataFiles`, and ".bak" files from older versions (restored if the
+    // original is missing).
+    void recoverInterruptedCommits(const string& directory, const vector<string>& dataFiles) {
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(directory.empty() ? "." : directory, ec)) {
+            string journal = entry.path().string();
+            if (journal.size() <= COMMIT_SUFFIX.size() ||
+                journal.compare(journal.size() - COMMIT_SUFFIX.size(), COMMIT_SUFFIX.size(), COMMIT_SUFFIX) != 0) {
+                continue;
+            }
+            ifstream in(journal);
+            string line;
+            if (!getline(in, line) || line != COMMIT_HEADER) continue;
+            vector<string> paths;
+            while (getline(in, line)) {
+                if (!line.empty()) paths.push_back(line);
+            }
+            in.close();
+            bool complete = true;
+            for (const auto& path : paths) {
+                if (fileExists(path + ".tmp") && !renameOver(path + ".tmp", path)) complete = false;
+            }
+            if (!complete) {
+                cerr << "Warning: could not finish the interrupted save recorded in " << journal << "\n";
+                continue;
+            }
+            syncToDisk(directoryOf(journal), true);
+            remove(journal.c_str());
+            cerr << "Note: finished an interrupted save of " << paths.size() << " file(s) (" << journal << ")\n";
         }
+        for (const auto& path : dataFiles) {
+            remove((path + ".tmp").c_str());
+            if (!fileExists(path + ".bak")) continue;
+            if (fileExists(path)) remove((path + ".bak").c_str());
+            else renameOver(path + ".bak", path);
+        }
+    }
+}
+// =================================================================================
+// =================================================================================
+// ||                      CHECKSUMMED DATA FILE FORMAT                           ||
+// =================================================================================
+// CRC32C (Castagnoli). Uses the SSE4.2 crc32 instruction when the CPU has it,
+// otherwise a slicing-by-8 table.
+namespace Crc32c {
+    inline const uint32_t (&tables())[8][256] {
+        static uint32_t table[8][256];
+        static once_flag built;
+        call_once(built, [] {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+                table[0][i] = crc;
+            }
+            for (uint32_t i = 0; i < 256; i++) {
+                for (int t = 1; t < 8; t++) table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xFF];
+            }
+        });
+        return table;
     }
 
-    // --- Data Loading and Saving (unchanged, but now safer due to parsing checks) ---
-    vector<Trainee> loadTrainees() {
-        vector<Trainee> trainees;
-        ifstream file(TRAINEE_FILE);
-        string line;
-        while (getline(file, line)) {
-            if (!line.empty()) trainees.push_back(Trainee::fromString(line));
+    inline uint32_t updateSoftware(uint32_t crc, const unsigned char* p, size_t n) {
+        const uint32_t (&t)[8][256] = tables();
+        while (n >= 8) {
+            uint32_t lo = crc ^ (uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24);
+            uint32_t hi = uint32_t(p[4]) | uint32_t(p[5]) << 8 | uint32_t(p[6]) << 16 | uint32_t(p[7]) << 24;
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+            p += 8;
+            n -= 8;
         }
-        file.close();
-        return trainees;
-    }
-    void saveTrainees(const vector<Trainee>& trainees) {
-        ofstream file(TRAINEE_FILE);
-        for (const auto& t : trainees) file << t.toString() << "\n";
-        file.close();
+        while (n--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+        return crc;
     }
-    vector<Trainer> loadTrainers() { 
-        vector<Trainer> trainers;
-        ifstream file(TRAINER_FILE);
-        string line;
-        while (getline(file, line)) {
-            if (!line.empty()) trainers.push_back(Trainer::fromString(line));
+
+#if GMS_HAVE_CRC32C_HW
+    __attribute__((target("sse4.2"))) inline uint32_t updateHardware(uint32_t crc, const unsigned char* p, size_t n) {
+        uint64_t c = crc;
+        while (n >= 8) {
+            uint64_t word;
+            memcpy(&word, p, 8);
+            c = _mm_crc32_u64(c, word);
+            p += 8;
+            n -= 8;
         }
-        file.close();
-        return trainers;
+        uint32_t c32 = static_cast<uint32_t>(c);
+        while (n--) c32 = _mm_crc32_u8(c32, *p++);
+        return c32;
     }
-    void saveTrainers(const vector<Trainer>& trainers) { 
-        ofstream file(TRAINER_FILE);
-        for (const auto& t : trainers) file << t.toString() << "\n";
-        file.close();
+
+    inline bool hardwareAvailable() {
+        static const bool available = __builtin_cpu_supports("sse4.2");
+        return available;
     }
-    vector<GymClass> loadClasses() { 
-        vector<GymClass> classes;
-        ifstream file(CLASS_FILE);
-        string line;
-        while (getline(file, line)) {
-            if (!line.empty()) classes.push_back(GymClass::fromString(line));
-        }
-        file.close();
-        return classes;
+#else
+    inline bool hardwareAvailable() { return false; }
+#endif
+
+    // Continues a running CRC. Start from `init()` and pass the result through `finish()`.
+    inline uint32_t update(uint32_t state, const void* data, size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+#if GMS_HAVE_CRC32C_HW
+        if (hardwareAvailable()) return updateHardware(state, p, n);
+#endif
+        return updateSoftware(state, p, n);
     }
-    void saveClasses(const vector<GymClass>& classes) { 
-        ofstream file(CLASS_FILE);
-        for (const auto& c : classes) file << c.toString() << "\n";
-        file.close();
+
+    inline uint32_t init() { return 0xFFFFFFFFu; }
+    inline uint32_t finish(uint32_t state) { return ~state; }
+    inline uint32_t compute(const string& data) { return finish(update(init(), data.data(), data.size())); }
+}
+
+// Data files (trainees, trainers, classes) are written as
+//
+//   #GMS v1 table=<name> records=<total> block=<records per block>
+//   <record line> ... up to one block of records
+//   #B <block index> <records in block> <crc32c of the block's lines, '\n' included>
+//   ... more blocks ...
+//
+// Files without the header (older versions) still load; their records simply
+// count as unverified and go through full field validation.
+namespace DataFormat {
+    const int VERSION = 1;
+    const size_t BLOCK_RECORDS = 256;
+    const string HEADER_PREFIX = "#GMS ";
+    const string TRAILER_PREFIX = "#B ";
+
+    // Record lines never start with these, so a class called "#yoga" is still a record.
+    // Class lines begin with the class name, so names matching this are refused on entry.
+    inline bool isMetaLine(const string& line) {
+        return line.compare(0, HEADER_PREFIX.size(), HEADER_PREFIX) == 0 ||
+               line.compare(0, TRAILER_PREFIX.size(), TRAILER_PREFIX) == 0;
     }
 
-    // --- User Registration and Management (ENHANCED) ---
-    void registerTrainee() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                               REGISTER TRAINEE                              *\n";
-        cout << "********************************************************************************\n";
-        
+    // --- Strict field parsing for records that could not be verified ---
+    inline vector<string> splitFields(const string& line) {
+        vector<string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t comma = line.find(',', start);
+            fields.push_back(line.substr(start, comma == string::npos ? string::npos : comma - start));
+            if (comma == string::npos) return fields;
+            start = comma + 1;
+        }
+    }
+
+    inline bool toInt64(const string& text, int64_t& out) {
+        if (text.empty()) return false;
+        char* end = nullptr;
+        errno = 0;
+        long long value = strtoll(text.c_str(), &end, 10);
+        if (errno != 0 || *end != '\0') return false;
+        out = value;
+        return true;
+    }
+
+    inline bool toInt(const string& text, int& out) {
+        int64_t value;
+        if (!toInt64(text, value) || value < numeric_limits<int>::min() || value > numeric_limits<int>::max()) return false;
+        out = static_cast<int>(value);
+        return true;
+    }
+
+    inline bool toFloat(const string& text, float& out) {
+        if (text.empty()) return false;
+        char* end = nullptr;
+        errno = 0;
+        float value = strtof(text.c_str(), &end);
+        if (errno != 0 || *end != '\0' || !isfinite(value)) return false;
+        out = value;
+        return true;
+    }
+
+    // Builds a complete checksummed file in memory.
+    class Writer {
+    private:
+        string content;
+        size_t inBlock = 0;
+        size_t blockIndex = 0;
+        uint32_t crc = Crc32c::init();
+
+        void closeBlock() {
+            char trailer[64];
+            snprintf(trailer, sizeof(trailer), "#B %zu %zu %08x\n", blockIndex, inBlock, Crc32c::finish(crc));
+            content += trailer;
+            blockIndex++;
+            inBlock = 0;
+            crc = Crc32c::init();
+        }
+
+    public:
+        Writer(const string& table, size_t records) {
+            content = HEADER_PREFIX + "v" + to_string(VERSION) + " table=" + table + " records=" + to_string(records) +
+                      " block=" + to_string(BLOCK_RECORDS) + "\n";
+        }
+
+        void add(const string& line) {
+            size_t start = content.size();
+            content += line;
+            content += '\n';
+            crc = Crc32c::update(crc, content.data() + start, content.size() - start);
+            if (++inBlock == BLOCK_RECORDS) closeBlock();
+        }
+
+        string finish() {
+            if (inBlock > 0) closeBlock();
+            return move(content);
+        }
+    };
+
+    struct Header {
+        bool present = false;
+        int version = 0;
+        string table;
+        size_t records = 0;
+    };
+
+    inline Header parseHeader(const string& line) {
+        Header h;
+        if (line.compare(0, HEADER_PREFIX.size(), HEADER_PREFIX) != 0) return h;
+        h.present = true;
+        stringstream ss(line.substr(HEADER_PREFIX.size()));
+        string token;
+        while (ss >> token) {
+            if (token.size() > 1 && token[0] == 'v' && isdigit(static_cast<unsigned char>(token[1]))) h.version = atoi(token.c_str() + 1);
+            else if (token.compare(0, 6, "table=") == 0) h.table = token.substr(6);
+            else if (token.compare(0, 8, "records=") == 0) h.records = static_cast<size_t>(strtoull(token.c_str() + 8, nullptr, 10));
+        }
+        return h;
+    }
+
+    // "#B <index> <count> <crc>"; returns false if the trailer itself is garbled.
+    inline bool parseTrailer(const char* text, size_t length, size_t& count, uint32_t& crc) {
+        string line(text, length);
+        unsigned long long index = 0, n = 0;
+        unsigned int value = 0;
+        if (sscanf(line.c_str(), "#B %llu %llu %8x", &index, &n, &value) != 3) return false;
+        count = static_cast<size_t>(n);
+        crc = value;
+        return true;
+    }
+
+    // Streams every record line to `fn(line, verified)`. A record is verified when
+    // its block's trailer is present and both count and CRC match; everything in a
+    // legacy file, a damaged block or a torn tail arrives unverified.
+    template <typename F>
+    void readRecords(const string& path, F fn) {
+        ifstream file(path);
+        if (!file) return;
+        Header header;
+        vector<string> pending;
+        uint32_t crc = Crc32c::init();
+        size_t blockIndex = 0, total = 0, damaged = 0;
+        string line;
+        bool first = true;
+
+        auto flush = [&](bool verified) {
+            for (const auto& record : pending) fn(record, verified);
+            total += pending.size();
+            pending.clear();
+            crc = Crc32c::init();
+        };
+
+        while (getline(file, line)) {
+            if (first) {
+                first = false;
+                header = parseHeader(line);
+                if (header.present) continue;
+            }
+            if (line.empty()) continue;
+            if (isMetaLine(line)) {
+                size_t count = 0;
+                uint32_t expected = 0;
+                bool ok = header.present && parseTrailer(line.data(), line.size(), count, expected) &&
+                          count == pending.size() && Crc32c::finish(crc) == expected;
+                if (!ok) {
+                    damaged++;
+                    cerr << "Warning: " << path << " block " << blockIndex << " failed its checksum; revalidating its records.\n";
+                }
+                flush(ok);
+                blockIndex++;
+                continue;
+            }
+            pending.push_back(line);
+            crc = Crc32c::update(crc, line.data(), line.size());
+            crc = Crc32c::update(crc, "\n", 1);
+        }
+        if (header.present && !pending.empty()) {
+            cerr << "Warning: " << path << " ends without a block trailer (interrupted write?); revalidating "
+                 << pending.size() << " record(s).\n";
+        }
+        flush(false);
+        if (header.present && total != header.records && damaged == 0) {
+            cerr << "Warning: " << path << " holds " << total << " records but its header says " << header.records << ".\n";
+        }
+    }
+
+    struct DamagedBlock {
+        size_t index;
+        size_t firstLine;
+        size_t lastLine;
+        string reason;
+    };
+
+    struct VerifyReport {
+        string path;
+        bool exists = false;
+        Header header;
+        size_t records = 0;
+        size_t blocks = 0;
+        uint64_t bytes = 0;
+        double seconds = 0;
+        vector<DamagedBlock> damaged;
+
+        bool ok() const {
+            return exists && header.present && header.version == VERSION && damaged.empty() && records == header.records;
+        }
+    };
+
+    // Checks every block without decoding any record. The file is read in large
+    // chunks and lines are located with memchr, so the cost is close to one pass
+    // of the CRC over the bytes on disk.
+    inline VerifyReport verifyFile(const string& path) {
+        VerifyReport report;
+        report.path = path;
+        auto started = chrono::steady_clock::now();
+        ifstream file(path, ios::binary);
+        if (!file) return report;
+        report.exists = true;
+
+        vector<char> buffer(4 << 20);
+        size_t used = 0;          // bytes of buffer holding data
+        size_t lineNo = 0;        // 1-based number of the line being processed
+        size_t blockFirstLine = 0, inBlock = 0;
+        uint32_t crc = Crc32c::init();
+        bool sawFirstLine = false, eof = false;
+
+        auto handleLine = [&](const char* text, size_t length) { // length excludes '\n'
+            lineNo++;
+            if (!sawFirstLine) {
+                sawFirstLine = true;
+                report.header = parseHeader(string(text, min<size_t>(length, 256)));
+                if (report.header.present) return;
+            }
+            if (length == 0) return;
+            bool meta = (length >= TRAILER_PREFIX.size() && memcmp(text, TRAILER_PREFIX.data(), TRAILER_PREFIX.size()) == 0) ||
+                        (length >= HEADER_PREFIX.size() && memcmp(text, HEADER_PREFIX.data(), HEADER_PREFIX.size()) == 0);
+            if (!meta) {
+                if (inBlock == 0) blockFirstLine = lineNo;
+                inBlock++;
+                report.records++;
+                crc = Crc32c::update(crc, text, length + 1);
+                return;
+            }
+            size_t count = 0;
+            uint32_t expected = 0;
+            string reason;
+            if (!parseTrailer(text, length, count, expected)) reason = "unreadable block trailer";
+            else if (count != inBlock) reason = "record count " + to_string(inBlock) + " != " + to_string(count);
+            else if (Crc32c::finish(crc) != expected) reason = "checksum mismatch";
+            if (!reason.empty()) {
+                report.damaged.push_back(DamagedBlock{report.blocks, inBlock ? blockFirstLine : lineNo, lineNo, reason});
+            }
+            report.blocks++;
+            inBlock = 0;
+            crc = Crc32c::init();
+        };
+
+        while (!eof) {
+            file.read(buffer.data() + used, buffer.size() - used);
+            size_t got = static_cast<size_t>(file.gcount());
+            report.bytes += got;
+            used += got;
+            eof = (got == 0);
+            size_t start = 0;
+            while (start < used) {
+                const char* base = buffer.data() + start;
+                const char* newline = static_cast<const char*>(memchr(base, '\n', used - start));
+                if (!newline) break;
+                handleLine(base, newline - base);
+                start = (newline - buffer.data()) + 1;
+            }
+            if (eof && start < used) { // final line without '\n'
+                buffer.resize(max(buffer.size(), used + 1));
+                buffer[used] = '\n';
+                handleLine(buffer.data() + start, used - start);
+                start = used;
+            }
+            memmove(buffer.data(), buffer.data() + start, used - start);
+            used -= start;
+            if (used == buffer.size()) buffer.resize(buffer.size() * 2); // one very long line
+        }
+
+        if (inBlock > 0) {
+            report.damaged.push_back(DamagedBlock{report.blocks, blockFirstLine, lineNo, "missing block trailer (torn write?)"});
+        }
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return report;
+    }
+
+    inline void printReport(const VerifyReport& r) {
+        if (!r.exists) {
+            Console::print("{}: not present\n", r.path);
+            return;
+        }
+        if (!r.header.present) {
+            Console::print("{}: no checksum header (older format; rewritten on the next save), {} records\n", r.path, r.records);
+            return;
+        }
+        double mb = r.bytes / (1024.0 * 1024.0);
+        Console::print("{}: {} - v{}, {} records in {} blocks, {:.1f} MB in {:.3f} s", r.path, r.ok() ? "OK" : "DAMAGED",
+                       r.header.version, r.records, r.blocks, mb, r.seconds);
+        if (r.seconds > 0) Console::print(" ({:.0f} MB/s)", mb / r.seconds);
+        cout << "\n";
+        if (r.records != r.header.records) {
+            Console::print("    header says {} records, found {}\n", r.header.records, r.records);
+        }
+        for (const auto& d : r.damaged) {
+            Console::print("    block {} (lines {}-{}): {}\n", d.index, d.firstLine, d.lastLine, d.reason);
+        }
+    }
+}
+// =================================================================================
+// =================================================================================
+// ||                         PASSWORD HASHING (PBKDF2)                           ||
+// =================================================================================
+// Passwords are stored as "$pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>".
+// The iteration count is read from the GMS_HASH_ITERATIONS environment variable so
+// the cost can be tuned and benchmarked. Existing hashes keep their own count
+// until a successful login, which rehashes any below the configured cost.
+namespace PasswordUtils {
+
+    const string HASH_PREFIX = "$pbkdf2-sha256$";
+    const int DEFAULT_ITERATIONS = 10000;
+    const int MIN_IMPORT_ITERATIONS = 1000;
+    const size_t SALT_BYTES = 16;
+    const size_t HASH_BYTES = 32;
+
+    // Minimal SHA-256 (FIPS 180-4), enough for the PBKDF2-HMAC construction below.
+    class Sha256 {
+    private:
+        uint32_t state[8];
+        uint8_t block[64];
+        size_t blockLength = 0;
+        uint64_t totalBits = 0;
+
+        static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+        void compress(const uint8_t* chunk) {
+            static const uint32_t K[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+            uint32_t w[64];
+            for (int i = 0; i < 16; i++) {
+                w[i] = (uint32_t(chunk[i * 4]) << 24) | (uint32_t(chunk[i * 4 + 1]) << 16) |
+                       (uint32_t(chunk[i * 4 + 2]) << 8) | uint32_t(chunk[i * 4 + 3]);
+            }
+            for (int i = 16; i < 64; i++) {
+                uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; i++) {
+                uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+
+    public:
+        Sha256() {
+            static const uint32_t INIT[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+            for (int i = 0; i < 8; i++) state[i] = INIT[i];
+        }
+
+        void update(const uint8_t* data, size_t length) {
+            totalBits += uint64_t(length) * 8;
+            for (size_t i = 0; i < length; i++) {
+                block[blockLength++] = data[i];
+                if (blockLength == 64) {
+                    compress(block);
+                    blockLength = 0;
+                }
+            }
+        }
+
+        void update(const string& data) { update(reinterpret_cast<const uint8_t*>(data.data()), data.size()); }
+
+        string digest() {
+            uint64_t bits = totalBits;
+            uint8_t pad = 0x80;
+            update(&pad, 1);
+            uint8_t zero = 0;
+            while (blockLength != 56) update(&zero, 1);
+            uint8_t length[8];
+            for (int i = 0; i < 8; i++) length[i] = static_cast<uint8_t>(bits >> (56 - i * 8));
+            update(length, 8);
+            string out(32, '\0');
+            for (int i = 0; i < 8; i++) {
+                for (int j = 0; j < 4; j++) out[i * 4 + j] = static_cast<char>(state[i] >> (24 - j * 8));
+            }
+            return out;
+        }
+    };
+
+    string sha256(const string& data) {
+        Sha256 hasher;
+        hasher.update(data);
+        return hasher.digest();
+    }
+
+    // PBKDF2-HMAC-SHA256 with a single output block (32 bytes). The hasher states
+    // after absorbing the inner/outer padded key are computed once and copied for
+    // every iteration, halving the compressions per round.
+    string pbkdf2(const string& password, const string& salt, int iterations) {
+        string k = password.size() > 64 ? sha256(password) : password;
+        k.resize(64, '\0');
+        string innerPad(64, '\0'), outerPad(64, '\0');
+        for (int i = 0; i < 64; i++) {
+            innerPad[i] = static_cast<char>(k[i] ^ 0x36);
+            outerPad[i] = static_cast<char>(k[i] ^ 0x5c);
+        }
+        Sha256 innerKeyed, outerKeyed;
+        innerKeyed.update(innerPad);
+        outerKeyed.update(outerPad);
+
+        auto hmac = [&](const string& message) {
+            Sha256 inner = innerKeyed;
+            inner.update(message);
+            Sha256 outer = outerKeyed;
+            outer.update(inner.digest());
+            return outer.digest();
+        };
+
+        string u = hmac(salt + string("\0\0\0\1", 4));
+        string result = u;
+        for (int i = 1; i < iterations; i++) {
+            u = hmac(u);
+            for (size_t j = 0; j < result.size(); j++) result[j] ^= u[j];
+        }
+        return result;
+    }
+
+    string toHex(const string& bytes) {
+        static const char* digits = "0123456789abcdef";
+        string hex;
+        hex.reserve(bytes.size() * 2);
+        for (unsigned char b : bytes) {
+            hex += digits[b >> 4];
+            hex += digits[b & 15];
+        }
+        return hex;
+    }
+
+    string fromHex(const string& hex) {
+        string bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) bytes += static_cast<char>(stoi(hex.substr(i, 2), nullptr, 16));
+        return bytes;
+    }
+
+    // Compares every byte regardless of where the first mismatch is.
+    bool constantTimeEquals(const string& a, const string& b) {
+        size_t length = max(a.size(), b.size());
+        unsigned char diff = static_cast<unsigned char>(a.size() != b.size());
+        for (size_t i = 0; i < length; i++) {
+            unsigned char x = i < a.size() ? static_cast<unsigned char>(a[i]) : 0;
+            unsigned char y = i < b.size() ? static_cast<unsigned char>(b[i]) : 0;
+            diff |= x ^ y;
+        }
+        return diff == 0;
+    }
+
+    // Lets a tool that seeds scratch accounts cheaply (the replay) make that the
+    // configured cost, so its logins are not all upgrades; 0 restores the default.
+    atomic<int>& iterationOverride() {
+        static atomic<int> iterations(0);
+        return iterations;
+    }
+
+    int configuredIterations() {
+        int forced = iterationOverride();
+        if (forced > 0) return forced;
+        const char* env = getenv("GMS_HASH_ITERATIONS");
+        if (env) {
+            try {
+                int iterations = stoi(env);
+                if (iterations >= 1) return iterations;
+            } catch (const exception&) {}
+        }
+        return DEFAULT_ITERATIONS;
+    }
+
+    // Bulk imports may trade hash cost for speed, but not below this (or below
+    // the configured cost, if that is lower still).
+    int minimumImportIterations() { return min(MIN_IMPORT_ITERATIONS, configuredIterations()); }
+
+    bool isHashed(const string& stored) { return stored.compare(0, HASH_PREFIX.size(), HASH_PREFIX) == 0; }
+
+    // One device per thread, and every 32-bit draw is used: opening the device
+    // and reading it a byte at a time dominated bulk imports.
+    string randomSalt() {
+        thread_local random_device device;
+        string salt(SALT_BYTES, '\0');
+        for (size_t i = 0; i < SALT_BYTES; i += 4) {
+            uint32_t bits = device();
+            for (size_t j = 0; j < 4 && i + j < SALT_BYTES; j++) salt[i + j] = static_cast<char>(bits >> (j * 8));
+        }
+        return salt;
+    }
+
+    string hashPassword(const string& password, int iterations = configuredIterations()) {
+        string salt = randomSalt();
+        return HASH_PREFIX + to_string(iterations) + "$" + toHex(salt) + "$" + toHex(pbkdf2(password, salt, iterations));
+    }
+
+    // The PBKDF2 iteration count recorded in a stored hash; 0 if it is not one.
+    int iterationsOf(const string& stored) {
+        if (!isHashed(stored)) return 0;
+        size_t iterEnd = stored.find('$', HASH_PREFIX.size());
+        if (iterEnd == string::npos) return 0;
+        try {
+            return max(stoi(stored.substr(HASH_PREFIX.size(), iterEnd - HASH_PREFIX.size())), 0);
+        } catch (const exception&) {
+            return 0;
+        }
+    }
+
+    // Verifies a password against a stored hash. Malformed hashes never match.
+    bool verifyPassword(const string& password, const string& stored) {
+        if (!isHashed(stored)) return false;
+        size_t iterEnd = stored.find('$', HASH_PREFIX.size());
+        size_t saltEnd = (iterEnd == string::npos) ? string::npos : stored.find('$', iterEnd + 1);
+        if (saltEnd == string::npos) return false;
+        try {
+            int iterations = stoi(stored.substr(HASH_PREFIX.size(), iterEnd - HASH_PREFIX.size()));
+            string salt = fromHex(stored.substr(iterEnd + 1, saltEnd - iterEnd - 1));
+            string expected = stored.substr(saltEnd + 1);
+            return constantTimeEquals(toHex(pbkdf2(password, salt, max(iterations, 1))), expected);
+        } catch (const exception&) {
+            return false;
+        }
+    }
+}
+// =================================================================================
+
+
+// =================================================================================
+// ||                      COMPRESSED ENROLLMENT ID SETS                          ||
+// =================================================================================
+// Roaring-style set of trainee IDs. IDs are split by their high 16 bits into
+// containers kept sorted by key; a container holds its low 16 bits as a sorted
+// uint16 array while small and switches to a 65536-bit bitmap once it grows past
+// ARRAY_LIMIT entries. Membership is a binary search over containers plus a
+// binary search or bit test inside one, and intersections/unions work container
+// by container. Cardinality is tracked by the set itself.
+class TraineeIdSet {
+private:
+    static const size_t ARRAY_LIMIT = 4096;
+    static const size_t BITMAP_WORDS = 65536 / 64;
+
+    struct Container {
+        uint16_t key = 0;
+        vector<uint16_t> array;   // sorted low bits, used while cardinality <= ARRAY_LIMIT
+        vector<uint64_t> bitmap;  // BITMAP_WORDS words once converted
+        size_t cardinality = 0;
+
+        bool isBitmap() const { return !bitmap.empty(); }
+
+        bool contains(uint16_t low) const {
+            if (isBitmap()) return (bitmap[low >> 6] >> (low & 63)) & 1;
+            return binary_search(array.begin(), array.end(), low);
+        }
+
+        bool add(uint16_t low) {
+            if (isBitmap()) {
+                uint64_t mask = uint64_t(1) << (low & 63);
+                if (bitmap[low >> 6] & mask) return false;
+                bitmap[low >> 6] |= mask;
+            } else {
+                auto it = lower_bound(array.begin(), array.end(), low);
+                if (it != array.end() && *it == low) return false;
+                array.insert(it, low);
+                if (array.size() > ARRAY_LIMIT) toBitmap();
+            }
+            cardinality++;
+            return true;
+        }
+
+        bool remove(uint16_t low) {
+            if (isBitmap()) {
+                uint64_t mask = uint64_t(1) << (low & 63);
+                if (!(bitmap[low >> 6] & mask)) return false;
+                bitmap[low >> 6] &= ~mask;
+                cardinality--;
+                if (cardinality <= ARRAY_LIMIT / 2) toArray();
+            } else {
+                auto it = lower_bound(array.begin(), array.end(), low);
+                if (it == array.end() || *it != low) return false;
+                array.erase(it);
+                cardinality--;
+            }
+            return true;
+        }
+
+        void toBitmap() {
+            bitmap.assign(BITMAP_WORDS, 0);
+            for (uint16_t low : array) bitmap[low >> 6] |= uint64_t(1) << (low & 63);
+            array.clear();
+            array.shrink_to_fit();
+        }
+
+        void toArray() {
+            vector<uint16_t> values;
+            values.reserve(cardinality);
+            forEach([&values](uint16_t low) { values.push_back(low); });
+            array.swap(values);
+            bitmap.clear();
+            bitmap.shrink_to_fit();
+        }
+
+        template <typename F>
+        void forEach(F fn) const {
+            if (!isBitmap()) {
+                for (uint16_t low : array) fn(low);
+                return;
+            }
+            for (size_t w = 0; w < BITMAP_WORDS; w++) {
+                uint64_t word = bitmap[w];
+                while (word) {
+                #if defined(__GNUC__) || defined(__clang__)
+                    int bit = __builtin_ctzll(word);
+                #else
+                    int bit = 0;
+                    while (!((word >> bit) & 1)) bit++;
+                #endif
+                    fn(static_cast<uint16_t>(w * 64 + bit));
+                    word &= word - 1;
+                }
+            }
+        }
+    };
+
+    vector<Container> containers; // sorted by key
+    size_t total = 0;
+
+    // IDs are mapped to unsigned so negative IDs still have a unique slot.
+    static uint32_t toKey(int id) { return static_cast<uint32_t>(id); }
+
+    vector<Container>::const_iterator findContainer(uint16_t key) const {
+        auto it = lower_bound(containers.begin(), containers.end(), key,
+                              [](const Container& c, uint16_t k) { return c.key < k; });
+        return (it != containers.end() && it->key == key) ? it : containers.end();
+    }
+
+    static Container combine(const Container& a, const Container& b, bool intersect) {
+        Container result;
+        result.key = a.key;
+        if (a.isBitmap() && b.isBitmap()) {
+            result.bitmap.assign(BITMAP_WORDS, 0);
+            for (size_t w = 0; w < BITMAP_WORDS; w++) {
+                uint64_t word = intersect ? (a.bitmap[w] & b.bitmap[w]) : (a.bitmap[w] | b.bitmap[w]);
+                result.bitmap[w] = word;
+                while (word) {
+                    result.cardinality++;
+                    word &= word - 1;
+                }
+            }
+            if (result.cardinality <= ARRAY_LIMIT) result.toArray();
+            return result;
+        }
+        if (intersect) {
+            // Probe the larger container with every element of the smaller one.
+            const Container& small = (a.cardinality <= b.cardinality) ? a : b;
+            const Container& large = (&small == &a) ? b : a;
+            small.forEach([&](uint16_t low) {
+                if (large.contains(low)) {
+                    result.array.push_back(low);
+                    result.cardinality++;
+                }
+            });
+            return result;
+        }
+        result = a;
+        b.forEach([&result](uint16_t low) { result.add(low); });
+        return result;
+    }
+
+    static TraineeIdSet combineSets(const TraineeIdSet& a, const TraineeIdSet& b, bool intersect) {
+        TraineeIdSet result;
+        size_t i = 0, j = 0;
+        while (i < a.containers.size() || j < b.containers.size()) {
+            bool takeA = j >= b.containers.size() || (i < a.containers.size() && a.containers[i].key < b.containers[j].key);
+            bool takeB = i >= a.containers.size() || (j < b.containers.size() && b.containers[j].key < a.containers[i].key);
+            if (takeA) {
+                if (!intersect) result.containers.push_back(a.containers[i]);
+                i++;
+            } else if (takeB) {
+                if (!intersect) result.containers.push_back(b.containers[j]);
+                j++;
+            } else {
+                Container merged = combine(a.containers[i], b.containers[j], intersect);
+                if (merged.cardinality > 0) result.containers.push_back(merged);
+                i++;
+                j++;
+            }
+        }
+        for (const auto& c : result.containers) result.total += c.cardinality;
+        return result;
+    }
+
+    static const string& base64Alphabet() {
+        static const string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        return alphabet;
+    }
+
+public:
+    // Prefix marking the compact encoding; anything else is the legacy "1;2;3" list.
+    static constexpr const char* ENCODING_PREFIX = "r1:";
+
+    bool contains(int id) const {
+        uint32_t value = toKey(id);
+        auto it = findContainer(static_cast<uint16_t>(value >> 16));
+        return it != containers.end() && it->contains(static_cast<uint16_t>(value & 0xFFFF));
+    }
+
+    bool add(int id) {
+        uint32_t value = toKey(id);
+        uint16_t key = static_cast<uint16_t>(value >> 16);
+        auto it = lower_bound(containers.begin(), containers.end(), key,
+                              [](const Container& c, uint16_t k) { return c.key < k; });
+        if (it == containers.end() || it->key != key) {
+            Container fresh;
+            fresh.key = key;
+            it = containers.insert(it, fresh);
+        }
+        if (!it->add(static_cast<uint16_t>(value & 0xFFFF))) return false;
+        total++;
+        return true;
+    }
+
+    bool remove(int id) {
+        uint32_t value = toKey(id);
+        uint16_t key = static_cast<uint16_t>(value >> 16);
+        auto it = lower_bound(containers.begin(), containers.end(), key,
+                              [](const Container& c, uint16_t k) { return c.key < k; });
+        if (it == containers.end() || it->key != key) return false;
+        if (!it->remove(static_cast<uint16_t>(value & 0xFFFF))) return false;
+        if (it->cardinality == 0) containers.erase(it);
+        total--;
+        return true;
+    }
+
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+    void clear() {
+        containers.clear();
+        total = 0;
+    }
+
+    template <typename F>
+    void forEach(F fn) const {
+        for (const auto& c : containers) {
+            uint32_t high = static_cast<uint32_t>(c.key) << 16;
+            c.forEach([&](uint16_t low) { fn(static_cast<int>(high | low)); });
+        }
+    }
+
+    vector<int> toVector() const {
+        vector<int> ids;
+        ids.reserve(total);
+        forEach([&ids](int id) { ids.push_back(id); });
+        return ids;
+    }
+
+    static TraineeIdSet intersection(const TraineeIdSet& a, const TraineeIdSet& b) { return combineSets(a, b, true); }
+    static TraineeIdSet unionOf(const TraineeIdSet& a, const TraineeIdSet& b) { return combineSets(a, b, false); }
+
+    // Compact text form for classes.txt: "r1:" + base64(varint count, varint deltas
+    // between consecutive sorted IDs). The alphabet never contains ',' or newlines.
+    string encode() const {
+        if (empty()) return "";
+        string bytes;
+        auto putVarint = [&bytes](uint32_t v) {
+            while (v >= 0x80) {
+                bytes += static_cast<char>((v & 0x7F) | 0x80);
+                v >>= 7;
+            }
+            bytes += static_cast<char>(v);
+        };
+        putVarint(static_cast<uint32_t>(total));
+        uint32_t previous = 0;
+        forEach([&](int id) {
+            uint32_t value = toKey(id);
+            putVarint(value - previous);
+            previous = value;
+        });
+
+        const string& alphabet = base64Alphabet();
+        string text = ENCODING_PREFIX;
+        for (size_t i = 0; i < bytes.size(); i += 3) {
+            uint32_t chunk = static_cast<uint8_t>(bytes[i]) << 16;
+            if (i + 1 < bytes.size()) chunk |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+            if (i + 2 < bytes.size()) chunk |= static_cast<uint8_t>(bytes[i + 2]);
+            text += alphabet[(chunk >> 18) & 63];
+            text += alphabet[(chunk >> 12) & 63];
+            text += (i + 1 < bytes.size()) ? alphabet[(chunk >> 6) & 63] : '=';
+            text += (i + 2 < bytes.size()) ? alphabet[chunk & 63] : '=';
+        }
+        return text;
+    }
+
+    // Accepts both the compact encoding and the legacy ';'-joined decimal list.
+    // Throws invalid_argument on malformed input, like the other record parsers.
+    static TraineeIdSet decode(const string& text) {
+        TraineeIdSet set;
+        if (text.empty()) return set;
+
+        const string prefix = ENCODING_PREFIX;
+        if (text.compare(0, prefix.size(), prefix) != 0) {
+            stringstream idStream(text);
+            string idStr;
+            while (getline(idStream, idStr, ';')) {
+                if (!idStr.empty()) set.add(stoi(idStr));
+            }
+            return set;
+        }
+
+        const string& alphabet = base64Alphabet();
+        string bytes;
+        uint32_t chunk = 0;
+        int bits = 0;
+        for (size_t i = prefix.size(); i < text.size() && text[i] != '='; i++) {
+            size_t digit = alphabet.find(text[i]);
+            if (digit == string::npos) throw invalid_argument("bad enrollment encoding");
+            chunk = (chunk << 6) | static_cast<uint32_t>(digit);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                bytes += static_cast<char>((chunk >> bits) & 0xFF);
+            }
+        }
+
+        size_t pos = 0;
+        auto getVarint = [&]() {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                if (pos >= bytes.size()) throw invalid_argument("truncated enrollment encoding");
+                uint8_t byte = static_cast<uint8_t>(bytes[pos++]);
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            throw invalid_argument("bad enrollment varint");
+        };
+        uint32_t count = getVarint();
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            value += getVarint();
+            set.add(static_cast<int>(value));
+        }
+        return set;
+    }
+};
+// =================================================================================
+
+
+struct Trainer {
+    int id;
+    string name;
+    string specialization;
+    string contact;
+    string password;
+
+    Trainer() : id(0) {}
+    Trainer(int _id, string _name, string _specialization, string _contact, string _password)
+        : id(_id), name(_name), specialization(_specialization), contact(_contact), password(_password) {}
+
+    void updateProfile() {
+        Console::banner("UPDATE TRAINER PROFILE");
+        name = InputUtils::get_non_empty_string("Enter new name: ");
+        specialization = InputUtils::get_non_empty_string("Enter new specialization: ");
+        contact = InputUtils::get_contact_number("Enter new contact (10 digits): ");
+        password = InputUtils::get_hidden_password("Enter new password: ");
+        cout << "Profile updated successfully!\n";
+    }
+
+    string toString() const { return format(password); }
+
+    // The file line with the password field left empty, for the change feed.
+    string redactedString() const { return format(""); }
+
+    string format(const string& passwordField) const {
+        return to_string(id) + "," + name + "," + specialization + "," + contact + "," + passwordField;
+    }
+
+    static Trainer fromString(const string& line) {
+        Trainer t;
+        stringstream ss(line);
+        string item;
+        try {
+            getline(ss, item, ','); t.id = stoi(item);
+            getline(ss, t.name, ',');
+            getline(ss, t.specialization, ',');
+            getline(ss, t.contact, ',');
+            getline(ss, t.password, ',');
+        } catch (const exception& e) {
+            cerr << "Error parsing Trainer from string: " << line << endl;
+        }
+        return t;
+    }
+
+    // Field-by-field validation for lines whose block checksum did not verify.
+    static bool parse(const string& line, Trainer& out) {
+        vector<string> f = DataFormat::splitFields(line);
+        Trainer t;
+        if (f.size() != 5 || !DataFormat::toInt(f[0], t.id) || f[1].empty() || f[4].empty()) return false;
+        t.name = f[1];
+        t.specialization = f[2];
+        t.contact = f[3];
+        t.password = f[4];
+        out = t;
+        return true;
+    }
+};
+
+struct Trainee {
+    int id;
+    string name;
+    string contact;
+    string password;
+    string membership_package; // "Basic" or "Premium"
+    int membership_duration_months; // 3 or 6
+    string payment_status; // "Paid" or "Due"
+    float height_m; // in meters
+    float weight_kg; // in kg
+    int64_t membership_start; // seconds since epoch, 0 if unknown (legacy record)
+    int64_t membership_expiry; // seconds since epoch, 0 if unknown (legacy record)
+
+    Trainee() : id(0), membership_duration_months(0), height_m(0), weight_kg(0), membership_start(0), membership_expiry(0) {}
+    Trainee(int _id, string _name, string _contact, string _password, string package, int duration)
+        : id(_id), name(_name), contact(_contact), password(_password), 
+          membership_package(package), membership_duration_months(duration),
+          payment_status("Paid"), height_m(0), weight_kg(0) {
+        startMembership(time(nullptr));
+    }
+
+    void startMembership(time_t start) {
+        membership_start = static_cast<int64_t>(start);
+        membership_expiry = static_cast<int64_t>(ScheduleUtils::addMonths(start, membership_duration_months));
+    }
+
+    bool isMembershipActive(time_t now) const {
+        return payment_status == "Paid" && static_cast<int64_t>(now) < membership_expiry;
+    }
+
+    float calculateBMI() {
+        if (height_m > 0 && weight_kg > 0) {
+            return weight_kg / (height_m * height_m);
+        }
+        return 0;
+    }
+    
+    void updateProfile() {
+        Console::banner("UPDATE TRAINEE PROFILE");
+        name = InputUtils::get_non_empty_string("Enter new name: ");
+        contact = InputUtils::get_contact_number("Enter new contact (10 digits): ");
+        password = InputUtils::get_hidden_password("Enter new password: ");
+        cout << "Profile updated successfully!\n";
+    }
+
+    string toString() const { return format(password); }
+
+    // The file line with the password field left empty, for the change feed.
+    string redactedString() const { return format(""); }
+
+    string format(const string& passwordField) const {
+        return to_string(id) + "," + name + "," + contact + "," + passwordField + "," + 
+               membership_package + "," + to_string(membership_duration_months) + "," + payment_status + "," +
+               to_string(height_m) + "," + to_string(weight_kg) + "," +
+               to_string(membership_start) + "," + to_string(membership_expiry);
+    }
+
+    static Trainee fromString(const string& line) {
+        Trainee t;
+        stringstream ss(line);
+        string item;
+        try {
+            getline(ss, item, ','); t.id = stoi(item);
+            getline(ss, t.name, ',');
+            getline(ss, t.contact, ',');
+            getline(ss, t.password, ',');
+            getline(ss, t.membership_package, ',');
+            getline(ss, item, ','); t.membership_duration_months = stoi(item);
+            getline(ss, t.payment_status, ',');
+            getline(ss, item, ','); t.height_m = stof(item);
+            getline(ss, item, ','); t.weight_kg = stof(item);
+            if (getline(ss, item, ',') && !item.empty()) t.membership_start = stoll(item);
+            if (getline(ss, item, ',') && !item.empty()) t.membership_expiry = stoll(item);
+        } catch (const exception& e) {
+            cerr << "Error parsing Trainee from string: " << line << endl;
+        }
+        return t;
+    }
+
+    // Field-by-field validation for lines whose block checksum did not verify.
+    // Legacy rows without the membership dates (9 fields) are still accepted.
+    static bool parse(const string& line, Trainee& out) {
+        vector<string> f = DataFormat::splitFields(line);
+        Trainee t;
+        if ((f.size() != 9 && f.size() != 11) || !DataFormat::toInt(f[0], t.id) || f[1].empty() || f[3].empty() ||
+            !DataFormat::toInt(f[5], t.membership_duration_months) ||
+            !DataFormat::toFloat(f[7], t.height_m) || !DataFormat::toFloat(f[8], t.weight_kg)) {
+            return false;
+        }
+        if (f.size() == 11 && (!DataFormat::toInt64(f[9], t.membership_start) || !DataFormat::toInt64(f[10], t.membership_expiry))) {
+            return false;
+        }
+        t.name = f[1];
+        t.contact = f[2];
+        t.password = f[3];
+        t.membership_package = f[4];
+        t.payment_status = f[6];
+        out = t;
+        return true;
+    }
+};
+
+struct GymClass {
+    static const int DEFAULT_DURATION_MINUTES = 60;
+
+    string className;
+    string schedule; // Format: "Day-HH:MM", e.g., "Mon-10:00"
+    string trainerName;
+    int capacity;
+    TraineeIdSet enrolledTrainees;
+    int duration_minutes; // Length of the session, used for trainer conflict checks
+
+    GymClass() : capacity(0), duration_minutes(DEFAULT_DURATION_MINUTES) {}
+    GymClass(string _className, string _schedule, string _trainerName, int _capacity,
+             int _duration = DEFAULT_DURATION_MINUTES)
+        : className(_className), schedule(_schedule), trainerName(_trainerName),
+          capacity(_capacity), duration_minutes(_duration) {}
+
+    int enrolledCount() const { return static_cast<int>(enrolledTrainees.size()); }
+    bool isEnrolled(int traineeId) const { return enrolledTrainees.contains(traineeId); }
+
+    // The enrolled column is written for readers of the file only; on load the
+    // count is always derived from the ID set. The duration is appended as the
+    // last field so older files (without it) still load.
+    string toString() const {
+        return className + "," + schedule + "," + trainerName + "," + 
+               to_string(capacity) + "," + to_string(enrolledCount()) + "," +
+               enrolledTrainees.encode() + "," + to_string(duration_minutes);
+    }
+
+    static GymClass fromString(const string& line) {
+        GymClass c;
+        stringstream ss(line);
+        string item;
+        try {
+            getline(ss, c.className, ',');
+            getline(ss, c.schedule, ',');
+            getline(ss, c.trainerName, ',');
+            getline(ss, item, ','); c.capacity = stoi(item);
+            getline(ss, item, ','); // stored enrolled count, superseded by the ID set
+            
+            getline(ss, item, ',');
+            c.enrolledTrainees = TraineeIdSet::decode(item);
+
+            if (getline(ss, item, ',') && !item.empty()) c.duration_minutes = stoi(item);
+        } catch (const exception& e) {
+             cerr << "Error parsing GymClass from string: " << line << endl;
+        }
+        return c;
+    }
+
+    // Field-by-field validation for lines whose block checksum did not verify.
+    static bool parse(const string& line, GymClass& out) {
+        vector<string> f = DataFormat::splitFields(line);
+        GymClass c;
+        if ((f.size() != 6 && f.size() != 7) || f[0].empty() || ScheduleUtils::toMinuteOfWeek(f[1]) < 0 ||
+            !DataFormat::toInt(f[3], c.capacity) || c.capacity < 0) {
+            return false;
+        }
+        if (f.size() == 7 && (!DataFormat::toInt(f[6], c.duration_minutes) || c.duration_minutes <= 0)) return false;
+        c.className = f[0];
+        c.schedule = f[1];
+        c.trainerName = f[2];
+        try {
+            c.enrolledTrainees = TraineeIdSet::decode(f[5]);
+        } catch (const exception&) {
+            return false; // damaged roster encoding
+        }
+        out = c;
+        return true;
+    }
+};
+
+// =================================================================================
+// ||                    CHECK-IN EVENT LOG & ATTENDANCE ROLLUPS                  ||
+// =================================================================================
+enum class CheckInKind : uint8_t {
+    Turnstile = 1,       // Member entered the gym floor
+    ClassAttendance = 2  // Member attended a scheduled class
+};
+
+struct CheckInEvent {
+    CheckInKind kind;
+    int64_t timestamp; // seconds since epoch
+    int traineeId;
+    string className; // empty for turnstile events
+};
+
+// Append-only binary log of check-in events. Producers (desk UI, turnstiles) only
+// push onto an in-memory queue; a single writer thread drains it in batches,
+// appends the batch to disk and folds it into hourly/daily rollups, so queries
+// never touch raw history after startup. The rollups are checkpointed to
+// "<log>.rollup" together with the log offset they cover, so a restart only
+// replays the events appended after the last checkpoint.
+//
+// Layout: the text line HEADER, then records of u8 kind | i64 timestamp |
+// i32 trainee id | u16 class name length | class name bytes, all little-endian.
+// Logs from older versions (no header, native byte order) are rewritten once.
+class CheckInLog {
+private:
+    typedef map<int64_t, int> Buckets; // bucket number -> event count
+
+    static const size_t RECORD_FIXED_BYTES = 1 + 8 + 4 + 2;
+    static const size_t CHECKPOINT_EVERY = 5000; // events between rollup checkpoints
+
+    const string LOG_FILE;
+    const string ROLLUP_FILE;
+
+    mutex queueMutex;
+    condition_variable queueChanged;
+    deque<CheckInEvent> pending;
+    bool writing = false;
+    bool stopping = false;
+    string lastError;
+    thread writer;
+
+    mutable mutex rollupMutex;
+    unordered_map<int, Buckets> traineeHourly, traineeDaily;
+    unordered_map<string, Buckets> classHourly, classDaily;
+    uintmax_t logEnd = 0;       // bytes of whole records the rollups cover
+    size_t sinceCheckpoint = 0; // events folded in since the last checkpoint
+    bool logReady = false;      // the log has the current header
+    mutex checkpointMutex;      // orders writes of ROLLUP_FILE
+
+    static const string& HEADER() {
+        static const string header = "#GMS checkins v2\n";
+        return header;
+    }
+
+    static const string& ROLLUP_HEADER() {
+        static const string header = "#GMS rollup v1";
+        return header;
+    }
+
+    static mutex& liveMutex() {
+        static mutex m;
+        return m;
+    }
+
+    static set<CheckInLog*>& live() {
+        static set<CheckInLog*> logs;
+        return logs;
+    }
+
+    static void bump(Buckets& buckets, int64_t bucket, int count = 1) { buckets[bucket] += count; }
+
+    static int sumRange(const Buckets& buckets, int64_t from, int64_t to) {
+        int total = 0;
+        for (auto it = buckets.lower_bound(from); it != buckets.end() && it->first <= to; ++it) total += it->second;
+        return total;
+    }
+
+    static int countNonEmpty(const Buckets& buckets, int64_t from, int64_t to) {
+        int total = 0;
+        for (auto it = buckets.lower_bound(from); it != buckets.end() && it->first <= to; ++it) {
+            if (it->second > 0) total++;
+        }
+        return total;
+    }
+
+    void applyToRollups(const CheckInEvent& e) {
+        int64_t hour = ScheduleUtils::localHourNumber(static_cast<time_t>(e.timestamp));
+        int64_t day = ScheduleUtils::localDayNumber(static_cast<time_t>(e.timestamp));
+        bump(traineeHourly[e.traineeId], hour);
+        bump(traineeDaily[e.traineeId], day);
+        if (e.kind == CheckInKind::ClassAttendance) {
+            bump(classHourly[e.className], hour);
+            bump(classDaily[e.className], day);
+        }
+    }
+
+    static void putLittleEndian(string& out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+
+    static uint64_t getLittleEndian(const unsigned char* in, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; i++) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        return value;
+    }
+
+    static void encodeEvent(string& out, const CheckInEvent& e) {
+        uint16_t nameLength = static_cast<uint16_t>(min<size_t>(e.className.size(), 0xFFFF));
+        putLittleEndian(out, static_cast<uint8_t>(e.kind), 1);
+        putLittleEndian(out, static_cast<uint64_t>(e.timestamp), 8);
+        putLittleEndian(out, static_cast<uint32_t>(e.traineeId), 4);
+        putLittleEndian(out, nameLength, 2);
+        out.append(e.className.data(), nameLength);
+    }
+
+    static bool validKind(uint8_t kind) {
+        return kind == static_cast<uint8_t>(CheckInKind::Turnstile) || kind == static_cast<uint8_t>(CheckInKind::ClassAttendance);
+    }
+
+    static bool readEvent(ifstream& in, CheckInEvent& e) {
+        unsigned char fixed[RECORD_FIXED_BYTES];
+        if (!in.read(reinterpret_cast<char*>(fixed), sizeof(fixed))) return false;
+        uint8_t kind = fixed[0];
+        uint16_t nameLength = static_cast<uint16_t>(getLittleEndian(fixed + 13, 2));
+        e.className.assign(nameLength, '\0');
+        if (nameLength > 0 && !in.read(&e.className[0], nameLength)) return false;
+        if (!validKind(kind)) return false;
+        e.kind = static_cast<CheckInKind>(kind);
+        e.timestamp = static_cast<int64_t>(getLittleEndian(fixed + 1, 8));
+        e.traineeId = static_cast<int32_t>(static_cast<uint32_t>(getLittleEndian(fixed + 9, 4)));
+        return true;
+    }
+
+    // The headerless format of earlier versions, in this machine's byte order.
+    static bool readLegacyEvent(ifstream& in, CheckInEvent& e) {
+        uint8_t kind;
+        int32_t id;
+        uint16_t nameLength;
+        if (!in.read(reinterpret_cast<char*>(&kind), sizeof(kind))) return false;
+        if (!in.read(reinterpret_cast<char*>(&e.timestamp), sizeof(e.timestamp))) return false;
+        if (!in.read(reinterpret_cast<char*>(&id), sizeof(id))) return false;
+        if (!in.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength))) return false;
+        e.className.assign(nameLength, '\0');
+        if (nameLength > 0 && !in.read(&e.className[0], nameLength)) return false;
+        if (!validKind(kind)) return false;
+        e.kind = static_cast<CheckInKind>(kind);
+        e.traineeId = id;
+        return true;
+    }
+
+    // Gives a missing or empty log its header and rewrites a headerless one in
+    // the current format (its readable records are kept). Returns false if the
+    // log cannot be used.
+    bool prepareLogFile() {
+        error_code ec;
+        uintmax_t size = filesystem::file_size(LOG_FILE, ec);
+        string first;
+        if (!ec && size > 0) {
+            ifstream in(LOG_FILE, ios::binary);
+            first.assign(min<uintmax_t>(size, HEADER().size()), '\0');
+            in.read(&first[0], first.size());
+            if (first == HEADER()) return true;
+        }
+        string content = HEADER();
+        if (!ec && size > 0) {
+            ifstream in(LOG_FILE, ios::binary);
+            CheckInEvent e;
+            size_t migrated = 0;
+            while (readLegacyEvent(in, e)) {
+                encodeEvent(content, e);
+                migrated++;
+            }
+            cerr << "Note: converting " << LOG_FILE << " to the current format (" << migrated << " event(s))\n";
+        }
+        string error;
+        if (FileUtils::replaceFilesAtomically({{LOG_FILE, content}}, error)) return true;
+        cerr << "Error: " << error << "\n";
+        return false;
+    }
+
+    // Restores the rollups saved at `offset` into the log. Returns the offset,
+    // or 0 if there is no usable checkpoint.
+    uintmax_t loadCheckpoint(uintmax_t logSize) {
+        ifstream in(ROLLUP_FILE);
+        string line;
+        if (!getline(in, line) || line.compare(0, ROLLUP_HEADER().size() + 1, ROLLUP_HEADER() + " ") != 0) return 0;
+        int64_t offset = 0;
+        if (!DataFormat::toInt64(line.substr(ROLLUP_HEADER().size() + 1), offset) ||
+            offset < static_cast<int64_t>(HEADER().size()) || static_cast<uintmax_t>(offset) > logSize) {
+            return 0;
+        }
+        unordered_map<int, Buckets> th, td;
+        unordered_map<string, Buckets> ch, cd;
+        bool complete = false;
+        while (getline(in, line)) {
+            if (line == "end") {
+                complete = true;
+                break;
+            }
+            stringstream ss(line);
+            string table;
+            int64_t bucket;
+            int count;
+            if (!(ss >> table >> bucket >> count)) return 0;
+            string key;
+            ss.get(); // the space before the key, which may itself contain spaces
+            getline(ss, key);
+            int id = 0;
+            if (table == "th" && DataFormat::toInt(key, id)) bump(th[id], bucket, count);
+            else if (table == "td" && DataFormat::toInt(key, id)) bump(td[id], bucket, count);
+            else if (table == "ch") bump(ch[key], bucket, count);
+            else if (table == "cd") bump(cd[key], bucket, count);
+            else return 0;
+        }
+        if (!complete) return 0;
+        traineeHourly.swap(th);
+        traineeDaily.swap(td);
+        classHourly.swap(ch);
+        classDaily.swap(cd);
+        return static_cast<uintmax_t>(offset);
+    }
+
+    // Caller holds rollupMutex; the text is written by writeCheckpoint once it is released.
+    string checkpointText() {
+        string content = ROLLUP_HEADER() + " " + to_string(logEnd) + "\n";
+        auto dump = [&content](const char* table, const string& key, const Buckets& buckets) {
+            for (const auto& b : buckets) content += string(table) + " " + to_string(b.first) + " " + to_string(b.second) + " " + key + "\n";
+        };
+        for (const auto& t : traineeHourly) dump("th", to_string(t.first), t.second);
+        for (const auto& t : traineeDaily) dump("td", to_string(t.first), t.second);
+        for (const auto& c : classHourly) dump("ch", c.first, c.second);
+        for (const auto& c : classDaily) dump("cd", c.first, c.second);
+        content += "end\n";
+        sinceCheckpoint = 0;
+        return content;
+    }
+
+    void writeCheckpoint(const string& content) {
+        lock_guard<mutex> lock(checkpointMutex);
+        string error;
+        if (!FileUtils::replaceFilesAtomically({{ROLLUP_FILE, content}}, error)) {
+            cerr << "Warning: could not save the check-in rollups: " << error << "\n";
+        }
+    }
+
+    // Rebuilds the rollups at startup from the last checkpoint plus the events
+    // after it. A torn or corrupt tail (a crash mid-append) is cut off, so the
+    // writer appends after the last whole record instead of behind bytes that
+    // would misalign everything after them.
+    void replay() {
+        if (!prepareLogFile()) return;
+        error_code ec;
+        uintmax_t size = filesystem::file_size(LOG_FILE, ec);
+        if (ec) return;
+        uintmax_t good = loadCheckpoint(size);
+        if (good == 0) good = HEADER().size();
+        size_t replayed = 0;
+        {
+            ifstream in(LOG_FILE, ios::binary);
+            in.seekg(static_cast<streamoff>(good));
+            CheckInEvent e;
+            while (readEvent(in, e)) {
+                applyToRollups(e);
+                good = static_cast<uintmax_t>(in.tellg());
+                replayed++;
+            }
+        }
+        logEnd = good;
+        sinceCheckpoint = replayed;
+        logReady = true;
+        if (size > good) {
+            filesystem::resize_file(LOG_FILE, good, ec);
+            if (ec) cerr << "Warning: could not truncate the damaged tail of " << LOG_FILE << ": " << ec.message() << "\n";
+            else cerr << "Warning: dropped " << (size - good) << " byte(s) of an incomplete record at the end of " << LOG_FILE << "\n";
+        }
+        if (sinceCheckpoint >= CHECKPOINT_EVERY) writeCheckpoint(checkpointText());
+    }
+
+    // Appends one batch. On failure the partial bytes are cut off again so the
+    // log still ends on a whole record, and the batch is not counted.
+    bool appendBatch(ofstream& out, const deque<CheckInEvent>& batch, string& error) {
+        if (!logReady) {
+            error = LOG_FILE + " could not be opened at startup";
+            return false;
+        }
+        if (!out.is_open()) out.open(LOG_FILE, ios::binary | ios::app);
+        if (!out) {
+            error = "could not open " + LOG_FILE + " for appending";
+            out.close();
+            out.clear();
+            return false;
+        }
+        string bytes;
+        for (const auto& e : batch) encodeEvent(bytes, e);
+        out.write(bytes.data(), bytes.size());
+        out.flush();
+        if (out.good()) {
+            string checkpoint;
+            {
+                lock_guard<mutex> rollupLock(rollupMutex);
+                for (const auto& e : batch) applyToRollups(e);
+                logEnd += bytes.size();
+                sinceCheckpoint += batch.size();
+                if (sinceCheckpoint >= CHECKPOINT_EVERY) checkpoint = checkpointText();
+            }
+            if (!checkpoint.empty()) writeCheckpoint(checkpoint);
+            return true;
+        }
+        error = "could not append to " + LOG_FILE;
+        out.close();
+        out.clear();
+        uintmax_t end;
+        {
+            lock_guard<mutex> rollupLock(rollupMutex);
+            end = logEnd;
+        }
+        error_code ec;
+        filesystem::resize_file(LOG_FILE, end, ec);
+        return false;
+    }
+
+    void writerLoop() {
+        ofstream out;
+        unique_lock<mutex> lock(queueMutex);
+        while (true) {
+            queueChanged.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty() && stopping) break;
+
+            deque<CheckInEvent> batch;
+            batch.swap(pending);
+            writing = true;
+            lock.unlock();
+
+            string error;
+            if (!appendBatch(out, batch, error)) {
+                error = to_string(batch.size()) + " check-in event(s) were not recorded: " + error;
+                cerr << "Error: " << error << "\n";
+            }
+
+            lock.lock();
+            if (!error.empty()) lastError = error;
+            writing = false;
+            queueChanged.notify_all();
+        }
+        lock.unlock();
+        checkpoint();
+    }
+
+public:
+    explicit CheckInLog(const string& logFile) : LOG_FILE(logFile), ROLLUP_FILE(logFile + ".rollup") {
+        replay();
+        static once_flag registered;
+        call_once(registered, [] {
+            // Built before registering so they are destroyed after flushAll runs.
+            liveMutex();
+            live();
+            atexit(flushAll);
+        });
+        {
+            lock_guard<mutex> lock(liveMutex());
+            live().insert(this);
+        }
+        writer = thread(&CheckInLog::writerLoop, this);
+    }
+
+    ~CheckInLog() {
+        {
+            lock_guard<mutex> lock(liveMutex());
+            live().erase(this);
+        }
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        if (writer.joinable()) writer.join();
+    }
+
+    CheckInLog(const CheckInLog&) = delete;
+    CheckInLog& operator=(const CheckInLog&) = delete;
+
+    // Never touches the disk; safe to call from the desk UI at any event rate.
+    void record(CheckInKind kind, int traineeId, const string& className = "", time_t when = time(nullptr)) {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            pending.push_back(CheckInEvent{kind, static_cast<int64_t>(when), traineeId, className});
+        }
+        queueChanged.notify_one();
+    }
+
+    // Blocks until every event recorded so far is on disk and visible to queries.
+    void flush() {
+        unique_lock<mutex> lock(queueMutex);
+        queueChanged.wait(lock, [this] { return pending.empty() && !writing; });
+    }
+
+    // Saves the rollups if events were added since the last checkpoint.
+    void checkpoint() {
+        string content;
+        {
+            lock_guard<mutex> lock(rollupMutex);
+            if (sinceCheckpoint == 0) return;
+            content = checkpointText();
+        }
+        writeCheckpoint(content);
+    }
+
+    // The error of an append that failed since the last check, or "" (does not wait).
+    string takeError() {
+        lock_guard<mutex> lock(queueMutex);
+        string error = move(lastError);
+        lastError.clear();
+        return error;
+    }
+
+    // Registered with atexit so exit() on end of input still writes queued events.
+    static void flushAll() {
+        lock_guard<mutex> lock(liveMutex());
+        for (CheckInLog* log : live()) {
+            log->flush();
+            log->checkpoint();
+        }
+    }
+
+    // --- Queries (day/hour numbers come from ScheduleUtils::localDayNumber/localHourNumber) ---
+    int traineeVisits(int traineeId, int64_t fromDay, int64_t toDay) const {
+        lock_guard<mutex> lock(rollupMutex);
+        auto it = traineeDaily.find(traineeId);
+        return (it == traineeDaily.end()) ? 0 : sumRange(it->second, fromDay, toDay);
+    }
+
+    int traineeDaysVisited(int traineeId, int64_t fromDay, int64_t toDay) const {
+        lock_guard<mutex> lock(rollupMutex);
+        auto it = traineeDaily.find(traineeId);
+        return (it == traineeDaily.end()) ? 0 : countNonEmpty(it->second, fromDay, toDay);
+    }
+
+    int classAttendance(const string& className, int64_t fromDay, int64_t toDay) const {
+        lock_guard<mutex> lock(rollupMutex);
+        auto it = classDaily.find(className);
+        return (it == classDaily.end()) ? 0 : sumRange(it->second, fromDay, toDay);
+    }
+
+    int traineeVisitsInHour(int traineeId, int64_t hour) const {
+        lock_guard<mutex> lock(rollupMutex);
+        auto it = traineeHourly.find(traineeId);
+        return (it == traineeHourly.end()) ? 0 : sumRange(it->second, hour, hour);
+    }
+
+    int classAttendanceInHour(const string& className, int64_t hour) const {
+        lock_guard<mutex> lock(rollupMutex);
+        auto it = classHourly.find(className);
+        return (it == classHourly.end()) ? 0 : sumRange(it->second, hour, hour);
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                         MEMBERSHIP EXPIRY ENGINE                            ||
+// =================================================================================
+// Min-heap of (expiry time, trainee id). Checking for lapsed memberships only
+// looks at the top of the heap, so the cost of each check is proportional to the
+// number of memberships that actually expire. Renewals simply push a new entry;
+// the outdated one is discarded when it surfaces because it no longer matches the
+// trainee's stored expiry.
+class MembershipExpiryQueue {
+private:
+    struct Entry {
+        int64_t expiry;
+        int traineeId;
+        bool operator>(const Entry& other) const {
+            return expiry != other.expiry ? expiry > other.expiry : traineeId > other.traineeId;
+        }
+    };
+    priority_queue<Entry, vector<Entry>, greater<Entry>> heap;
+
+public:
+    void clear() { heap = priority_queue<Entry, vector<Entry>, greater<Entry>>(); }
+
+    void schedule(int traineeId, int64_t expiry) { heap.push(Entry{expiry, traineeId}); }
+
+    bool hasDue(int64_t now) const { return !heap.empty() && heap.top().expiry <= now; }
+
+    // Removes and returns every (trainee id, expiry) pair due at or before `now`.
+    vector<pair<int, int64_t>> popDue(int64_t now) {
+        vector<pair<int, int64_t>> due;
+        while (hasDue(now)) {
+            due.push_back({heap.top().traineeId, heap.top().expiry});
+            heap.pop();
+        }
+        return due;
+    }
+
+    size_t size() const { return heap.size(); }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                       PER-TRAINER INTERVAL INDEX                            ||
+// =================================================================================
+// Keeps every trainer's bookings as sorted, half-open [start, end) minute-of-week
+// intervals. A booking that clashes with [start, end) starts before `end` and no
+// earlier than `start - longest`, so a check is one O(log n) lookup plus a walk
+// over that short window. This stays correct for legacy classes.txt files whose
+// bookings already overlap, where looking only at the predecessor is not enough.
+class TrainerScheduleIndex {
+private:
+    struct Booking {
+        int end;
+        string className;
+    };
+    // trainer name -> (start minute -> booking)
+    map<string, multimap<int, Booking>> bookings;
+    int longest = 0; // longest interval ever added, in minutes
+
+    // A class that runs past Sunday midnight is stored as two intervals.
+    static vector<pair<int, int>> toIntervals(int start, int duration) {
+        int end = start + duration;
+        if (end <= ScheduleUtils::MINUTES_PER_WEEK) return {{start, end}};
+        return {{start, ScheduleUtils::MINUTES_PER_WEEK}, {0, end - ScheduleUtils::MINUTES_PER_WEEK}};
+    }
+
+    const Booking* findOverlap(const multimap<int, Booking>& slots, int start, int end) const {
+        auto it = slots.lower_bound(end);
+        while (it != slots.begin()) {
+            --it;
+            if (it->first + longest <= start) break;
+            if (it->second.end > start) return &it->second;
+        }
+        return nullptr;
+    }
+
+public:
+    void clear() {
+        bookings.clear();
+        longest = 0;
+    }
+
+    // Returns the name of the clashing class, or an empty string if the slot is free.
+    string findConflict(const string& trainerName, int startMinute, int duration) const {
+        auto trainerIt = bookings.find(trainerName);
+        if (trainerIt == bookings.end()) return "";
+        for (const auto& interval : toIntervals(startMinute, duration)) {
+            if (const Booking* clash = findOverlap(trainerIt->second, interval.first, interval.second)) {
+                return clash->className;
+            }
+        }
+        return "";
+    }
+
+    bool isFree(const string& trainerName, int startMinute, int duration) const {
+        return findConflict(trainerName, startMinute, duration).empty();
+    }
+
+    vector<string> freeTrainers(const vector<string>& trainerNames, int startMinute, int duration) const {
+        vector<string> result;
+        for (const auto& name : trainerNames) {
+            if (isFree(name, startMinute, duration)) result.push_back(name);
+        }
+        return result;
+    }
+
+    void add(const GymClass& c) {
+        int start = ScheduleUtils::toMinuteOfWeek(c.schedule);
+        if (start < 0) return;
+        auto& slots = bookings[c.trainerName];
+        for (const auto& interval : toIntervals(start, c.duration_minutes)) {
+            slots.insert({interval.first, Booking{interval.second, c.className}});
+            longest = max(longest, interval.second - interval.first);
+        }
+    }
+
+    void remove(const GymClass& c) {
+        int start = ScheduleUtils::toMinuteOfWeek(c.schedule);
+        auto trainerIt = bookings.find(c.trainerName);
+        if (start < 0 || trainerIt == bookings.end()) return;
+        for (const auto& interval : toIntervals(start, c.duration_minutes)) {
+            auto range = trainerIt->second.equal_range(interval.first);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.className == c.className) {
+                    trainerIt->second.erase(it);
+                    break;
+                }
+            }
+        }
+        if (trainerIt->second.empty()) bookings.erase(trainerIt);
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                       TRAINEE ENROLLMENT INDEX                              ||
+// =================================================================================
+// The classes each trainee is enrolled in. A copy of every roster is kept as it
+// was indexed, so update() only needs the class as it is now: the difference
+// between the two rosters is applied, which costs O(roster) instead of a pass
+// over every class.
+class TraineeEnrollmentIndex {
+private:
+    unordered_map<string, TraineeIdSet> rosters;          // class name -> roster as indexed
+    unordered_map<int, unordered_set<string>> enrolledIn; // trainee id -> class names
+
+    void link(int id, const string& className) { enrolledIn[id].insert(className); }
+
+    void unlink(int id, const string& className) {
+        auto it = enrolledIn.find(id);
+        if (it == enrolledIn.end()) return;
+        it->second.erase(className);
+        if (it->second.empty()) enrolledIn.erase(it);
+    }
+
+public:
+    void clear() {
+        rosters.clear();
+        enrolledIn.clear();
+    }
+
+    void add(const GymClass& c) {
+        rosters[c.className] = c.enrolledTrainees;
+        c.enrolledTrainees.forEach([&](int id) { link(id, c.className); });
+    }
+
+    void remove(const GymClass& c) {
+        auto it = rosters.find(c.className);
+        if (it == rosters.end()) return;
+        it->second.forEach([&](int id) { unlink(id, c.className); });
+        rosters.erase(it);
+    }
+
+    void update(const GymClass& c) {
+        auto it = rosters.find(c.className);
+        if (it == rosters.end()) {
+            add(c);
+            return;
+        }
+        const TraineeIdSet& before = it->second;
+        before.forEach([&](int id) {
+            if (!c.enrolledTrainees.contains(id)) unlink(id, c.className);
+        });
+        c.enrolledTrainees.forEach([&](int id) {
+            if (!before.contains(id)) link(id, c.className);
+        });
+        it->second = c.enrolledTrainees;
+    }
+
+    vector<string> classesOf(int traineeId) const {
+        auto it = enrolledIn.find(traineeId);
+        if (it == enrolledIn.end()) return {};
+        return vector<string>(it->second.begin(), it->second.end());
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                       RENDERED SCHEDULE VIEW CACHE                          ||
+// =================================================================================
+// Holds the rendered text of the weekly and daily schedule screens. Each class
+// maps to one pre-formatted row inside its day; adding or removing a class only
+// re-joins that day. An enrollment change re-formats a single row and splices it
+// into the cached day and weekly text at the row's recorded offset, so no other
+// row or day is touched. Showing a schedule is then one write of a built string.
+class ScheduleViewCache {
+private:
+    struct Row {
+        string schedule;
+        string className;
+        string trainerName;
+        string text;
+        size_t offset; // of `text` within the day's joined rows, once rendered
+    };
+
+    static const int DAYS = 7;
+    vector<Row> rows[DAYS];          // per day, sorted by (schedule, className)
+    string weeklySection[DAYS];      // "--- Day ---" block used by the weekly view
+    string dailyScreen[DAYS];        // complete "classes for today" screen
+    size_t sectionBodyStart[DAYS];   // where the rows start in weeklySection[day]
+    size_t dailyBodyStart[DAYS];     // ... in dailyScreen[day]
+    size_t weeklyBodyStart[DAYS];    // ... in weeklyScreen, while it is not dirty
+    bool dayDirty[DAYS];
+    bool dayLoaded[DAYS];            // rows[day] reflects the class file
+    string weeklyScreen;
+    bool weeklyDirty = true;
+
+    static string renderRow(const GymClass& c) {
+        string time = c.schedule.substr(c.schedule.find('-') + 1);
+        return "  " + time + "   " + c.className + " (" + c.trainerName + ")" +
+               "   -   Enrolled: " + to_string(c.enrolledCount()) + "/" + to_string(c.capacity) + "\n";
+    }
+
+    static int dayOf(const GymClass& c) {
+        int minute = ScheduleUtils::toMinuteOfWeek(c.schedule);
+        return (minute < 0) ? -1 : minute / ScheduleUtils::MINUTES_PER_DAY;
+    }
+
+    static bool rowBefore(const Row& a, const Row& b) {
+        return a.schedule != b.schedule ? a.schedule < b.schedule : a.className < b.className;
+    }
+
+    // Binary search on the sort key; the trainer must match too.
+    vector<Row>::iterator findRow(int day, const GymClass& c) {
+        Row key{c.schedule, c.className, c.trainerName, "", 0};
+        auto it = lower_bound(rows[day].begin(), rows[day].end(), key, rowBefore);
+        for (; it != rows[day].end() && it->schedule == c.schedule && it->className == c.className; ++it) {
+            if (it->trainerName == c.trainerName) return it;
+        }
+        return rows[day].end();
+    }
+
+    void markDirty(int day) {
+        dayDirty[day] = true;
+        weeklyDirty = true;
+    }
+
+    void renderDay(int day) {
+        const string& name = ScheduleUtils::WEEK_DAYS[day];
+        string body;
+        for (auto& row : rows[day]) {
+            row.offset = body.size();
+            body += row.text;
+        }
+
+        weeklySection[day] = "\n--- " + name + " --------------------------------------------------------------------\n";
+        sectionBodyStart[day] = weeklySection[day].size();
+        weeklySection[day] += body.empty() ? "  No classes scheduled for this day.\n" : body;
+
+        dailyScreen[day] = "\n" + Console::bannerText("CLASSES FOR TODAY (" + name + ")");
+        dailyBodyStart[day] = dailyScreen[day].size();
+        dailyScreen[day] += body.empty() ? "No classes are scheduled for today. Take a rest day!\n" : body;
+        dayDirty[day] = false;
+    }
+
+public:
+    ScheduleViewCache() {
+        for (int day = 0; day < DAYS; day++) {
+            dayDirty[day] = true;
+            dayLoaded[day] = false;
+        }
+    }
+
+    void rebuild(const vector<GymClass>& classes) {
+        for (int day = 0; day < DAYS; day++) {
+            rows[day].clear();
+            dayLoaded[day] = true;
+            markDirty(day);
+        }
+        for (const auto& c : classes) addClass(c);
+    }
+
+    // Loads one day from a subset of classes; classes on other days are ignored.
+    void loadDay(int day, const vector<GymClass>& classes) {
+        rows[day].clear();
+        dayLoaded[day] = true;
+        markDirty(day);
+        for (const auto& c : classes) {
+            if (dayOf(c) == day) addClass(c);
+        }
+    }
+
+    bool isDayLoaded(int day) const { return dayLoaded[day]; }
+
+    // Changes to days that were never loaded are picked up when they are.
+    void addClass(const GymClass& c) {
+        int day = dayOf(c);
+        if (day < 0 || !dayLoaded[day]) return;
+        Row row{c.schedule, c.className, c.trainerName, renderRow(c), 0};
+        rows[day].insert(upper_bound(rows[day].begin(), rows[day].end(), row, rowBefore), row);
+        markDirty(day);
+    }
+
+    void removeClass(const GymClass& c) {
+        int day = dayOf(c);
+        if (day < 0 || !dayLoaded[day]) return;
+        auto it = findRow(day, c);
+        if (it == rows[day].end()) return;
+        rows[day].erase(it);
+        markDirty(day);
+    }
+
+    void updateEnrollment(const GymClass& c) {
+        int day = dayOf(c);
+        if (day < 0 || !dayLoaded[day]) return;
+        auto it = findRow(day, c);
+        if (it == rows[day].end()) return;
+        string text = renderRow(c);
+        if (text == it->text) return;
+        if (dayDirty[day]) { // re-joined on the next view anyway
+            it->text = move(text);
+            return;
+        }
+        // Splice the row into the built strings and shift what follows it.
+        size_t oldLength = it->text.size();
+        weeklySection[day].replace(sectionBodyStart[day] + it->offset, oldLength, text);
+        dailyScreen[day].replace(dailyBodyStart[day] + it->offset, oldLength, text);
+        if (!weeklyDirty) {
+            weeklyScreen.replace(weeklyBodyStart[day] + it->offset, oldLength, text);
+            for (int later = day + 1; later < DAYS; later++) weeklyBodyStart[later] = weeklyBodyStart[later] + text.size() - oldLength;
+        }
+        for (auto next = it + 1; next != rows[day].end(); ++next) next->offset = next->offset + text.size() - oldLength;
+        it->text = move(text);
+    }
+
+    const string& weekly() {
+        if (!weeklyDirty) return weeklyScreen;
+        bool anyClass = false;
+        for (int day = 0; day < DAYS; day++) {
+            if (dayDirty[day]) renderDay(day);
+            if (!rows[day].empty()) anyClass = true;
+        }
+        weeklyScreen = "\n" + Console::bannerText("WEEKLY CLASS SCHEDULE");
+        if (!anyClass) {
+            weeklyScreen += "No classes have been scheduled for the week.\n";
+            // No rows, so updateEnrollment never splices into it.
+        } else {
+            for (int day = 0; day < DAYS; day++) {
+                weeklyBodyStart[day] = weeklyScreen.size() + sectionBodyStart[day];
+                weeklyScreen += weeklySection[day];
+            }
+        }
+        weeklyDirty = false;
+        return weeklyScreen;
+    }
+
+    // dayIndex: 0 = Mon ... 6 = Sun
+    const string& daily(int dayIndex) {
+        if (dayDirty[dayIndex]) renderDay(dayIndex);
+        return dailyScreen[dayIndex];
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                       OCCUPANCY & UTILIZATION ANALYTICS                     ||
+// =================================================================================
+// Running totals behind the admin analytics view, updated by the same hooks as
+// the schedule caches: each class change subtracts the class's previous
+// contribution and adds the new one, so nothing is rescanned and rendering
+// only touches the 7x24 grid, the trainer table and the first N classes.
+class OccupancyAnalytics {
+public:
+    struct Cell {
+        long long enrolled = 0;
+        long long capacity = 0;
+        int classes = 0;
+    };
+
+    struct TrainerLoad {
+        string trainerName;
+        int classes = 0;
+        long long enrolled = 0;
+        long long capacity = 0;
+        long long minutesPerWeek = 0;
+    };
+
+    struct ClassFill {
+        string className;
+        string schedule;
+        int enrolled;
+        int capacity;
+    };
+
+private:
+    static const int DAYS = 7;
+    static const int HOURS = 24;
+
+    struct Snapshot {
+        string schedule;
+        string trainerName;
+        int startMinute; // -1 if the schedule is invalid
+        int duration;
+        int enrolled;
+        int capacity;
+    };
+
+    // Fullest first: by enrolled/capacity (compared exactly), then enrolled, then name.
+    struct FillOrder {
+        bool operator()(const ClassFill& a, const ClassFill& b) const {
+            long long lhs = static_cast<long long>(a.enrolled) * max(b.capacity, 1);
+            long long rhs = static_cast<long long>(b.enrolled) * max(a.capacity, 1);
+            if (lhs != rhs) return lhs > rhs;
+            if (a.enrolled != b.enrolled) return a.enrolled > b.enrolled;
+            return a.className < b.className;
+        }
+    };
+
+    Cell grid[DAYS][HOURS];
+    unordered_map<string, TrainerLoad> trainers;
+    unordered_map<string, Snapshot> classes;
+    set<ClassFill, FillOrder> byFill;
+
+    // Adds (sign = +1) or removes (sign = -1) one class from every aggregate.
+    void apply(const string& className, const Snapshot& s, int sign) {
+        if (s.startMinute >= 0) {
+            int end = s.startMinute + max(s.duration, 1);
+            for (int minute = s.startMinute - s.startMinute % 60; minute < end; minute += 60) {
+                int hourOfWeek = (minute % ScheduleUtils::MINUTES_PER_WEEK) / 60;
+                Cell& cell = grid[hourOfWeek / HOURS][hourOfWeek % HOURS];
+                cell.enrolled += sign * s.enrolled;
+                cell.capacity += sign * s.capacity;
+                cell.classes += sign;
+            }
+        }
+
+        TrainerLoad& load = trainers[s.trainerName];
+        load.trainerName = s.trainerName;
+        load.classes += sign;
+        load.enrolled += sign * s.enrolled;
+        load.capacity += sign * s.capacity;
+        load.minutesPerWeek += sign * s.duration;
+        if (load.classes == 0) trainers.erase(s.trainerName);
+
+        ClassFill fill{className, s.schedule, s.enrolled, s.capacity};
+        if (sign > 0) byFill.insert(fill);
+        else byFill.erase(fill);
+    }
+
+    static Snapshot snapshotOf(const GymClass& c) {
+        return Snapshot{c.schedule, c.trainerName, ScheduleUtils::toMinuteOfWeek(c.schedule),
+                        c.duration_minutes, c.enrolledCount(), c.capacity};
+    }
+
+public:
+    OccupancyAnalytics() { clear(); }
+
+    void clear() {
+        for (auto& day : grid) {
+            for (auto& cell : day) cell = Cell();
+        }
+        trainers.clear();
+        classes.clear();
+        byFill.clear();
+    }
+
+    void rebuild(const vector<GymClass>& all) {
+        clear();
+        for (const auto& c : all) addClass(c);
+    }
+
+    void addClass(const GymClass& c) {
+        auto it = classes.find(c.className);
+        if (it != classes.end()) apply(c.className, it->second, -1);
+        Snapshot s = snapshotOf(c);
+        classes[c.className] = s;
+        apply(c.className, s, +1);
+    }
+
+    void removeClass(const GymClass& c) {
+        auto it = classes.find(c.className);
+        if (it == classes.end()) return;
+        apply(c.className, it->second, -1);
+        classes.erase(it);
+    }
+
+    // Enrollment or capacity changed; same as re-adding the class.
+    void updateClass(const GymClass& c) { addClass(c); }
+
+    const Cell& cell(int day, int hour) const { return grid[day][hour]; }
+
+    size_t classCount() const { return classes.size(); }
+
+    vector<TrainerLoad> trainerLoads() const {
+        vector<TrainerLoad> loads;
+        for (const auto& entry : trainers) loads.push_back(entry.second);
+        sort(loads.begin(), loads.end(), [](const TrainerLoad& a, const TrainerLoad& b) {
+            return a.minutesPerWeek != b.minutesPerWeek ? a.minutesPerWeek > b.minutesPerWeek : a.trainerName < b.trainerName;
+        });
+        return loads;
+    }
+
+    vector<ClassFill> fullest(size_t n) const {
+        vector<ClassFill> top;
+        for (auto it = byFill.begin(); it != byFill.end() && top.size() < n; ++it) top.push_back(*it);
+        return top;
+    }
+
+    vector<ClassFill> emptiest(size_t n) const {
+        vector<ClassFill> bottom;
+        for (auto it = byFill.rbegin(); it != byFill.rend() && bottom.size() < n; ++it) bottom.push_back(*it);
+        return bottom;
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                             CLASS WAITLISTS                                 ||
+// =================================================================================
+// One line of waitlists.txt: a class and its queue, oldest first ("Yoga,12;7;30").
+struct WaitlistRecord {
+    string className;
+    vector<int> traineeIds;
+
+    string toString() const {
+        string line = className + ",";
+        for (size_t i = 0; i < traineeIds.size(); i++) {
+            if (i) line += ';';
+            line += to_string(traineeIds[i]);
+        }
+        return line;
+    }
+
+    static WaitlistRecord fromString(const string& line) {
+        WaitlistRecord r;
+        WaitlistRecord::parse(line, r);
+        return r;
+    }
+
+    static bool parse(const string& line, WaitlistRecord& out) {
+        size_t comma = line.rfind(',');
+        if (comma == string::npos || comma == 0) return false;
+        WaitlistRecord r;
+        r.className = line.substr(0, comma);
+        stringstream ss(line.substr(comma + 1));
+        string item;
+        while (getline(ss, item, ';')) {
+            int id;
+            if (!DataFormat::toInt(item, id)) return false;
+            r.traineeIds.push_back(id);
+        }
+        out = r;
+        return true;
+    }
+};
+
+// Per-class FIFO queues of trainees waiting for a seat. Each entry carries a
+// ticket; leaving the queue just forgets the ticket and the stale entry is
+// skipped once it reaches the front, so joining, leaving and promoting are all
+// O(1) amortized. Re-joining issues a new ticket, i.e. a place at the back.
+class ClassWaitlists {
+private:
+    struct Queue {
+        deque<pair<uint64_t, int>> order;    // (ticket, trainee id)
+        unordered_map<int, uint64_t> ticket; // live entries only
+    };
+
+    unordered_map<string, Queue> queues;
+    uint64_t nextTicket = 1;
+
+    static bool isLive(const Queue& q, const pair<uint64_t, int>& entry) {
+        auto it = q.ticket.find(entry.second);
+        return it != q.ticket.end() && it->second == entry.first;
+    }
+
+    static void dropStaleFront(Queue& q) {
+        while (!q.order.empty() && !isLive(q, q.order.front())) q.order.pop_front();
+    }
+
+public:
+    void clear() {
+        queues.clear();
+        nextTicket = 1;
+    }
+
+    void load(const vector<WaitlistRecord>& records) {
+        clear();
+        for (const auto& r : records) {
+            for (int id : r.traineeIds) enqueue(r.className, id);
+        }
+    }
+
+    // Live entries in queue order, one record per non-empty class.
+    vector<WaitlistRecord> records() const {
+        vector<WaitlistRecord> result;
+        for (const auto& entry : queues) {
+            WaitlistRecord r;
+            r.className = entry.first;
+            for (const auto& e : entry.second.order) {
+                if (isLive(entry.second, e)) r.traineeIds.push_back(e.second);
+            }
+            if (!r.traineeIds.empty()) result.push_back(r);
+        }
+        sort(result.begin(), result.end(),
+             [](const WaitlistRecord& a, const WaitlistRecord& b) { return a.className < b.className; });
+        return result;
+    }
+
+    bool contains(const string& className, int traineeId) const {
+        auto it = queues.find(className);
+        return it != queues.end() && it->second.ticket.count(traineeId) > 0;
+    }
+
+    size_t size(const string& className) const {
+        auto it = queues.find(className);
+        return it == queues.end() ? 0 : it->second.ticket.size();
+    }
+
+    // Returns false if the trainee is already waiting for this class.
+    bool enqueue(const string& className, int traineeId) {
+        Queue& q = queues[className];
+        if (q.ticket.count(traineeId)) return false;
+        uint64_t ticket = nextTicket++;
+        q.ticket[traineeId] = ticket;
+        q.order.emplace_back(ticket, traineeId);
+        return true;
+    }
+
+    bool remove(const string& className, int traineeId) {
+        auto it = queues.find(className);
+        if (it == queues.end() || !it->second.ticket.erase(traineeId)) return false;
+        dropStaleFront(it->second);
+        if (it->second.ticket.empty()) queues.erase(it);
+        return true;
+    }
+
+    // Removes a trainee from every queue; returns the classes they were waiting for.
+    vector<string> removeEverywhere(int traineeId) {
+        vector<string> classes;
+        for (auto& entry : queues) {
+            if (entry.second.ticket.count(traineeId)) classes.push_back(entry.first);
+        }
+        for (const auto& name : classes) remove(name, traineeId);
+        return classes;
+    }
+
+    bool dropClass(const string& className) { return queues.erase(className) > 0; }
+
+    // Pops the longest-waiting trainee for whom `eligible(id)` holds. Anyone found
+    // ineligible on the way is removed and reported in `dropped`. Returns -1 when
+    // the queue runs out.
+    template <typename F>
+    int popNext(const string& className, F eligible, vector<int>& dropped) {
+        auto it = queues.find(className);
+        if (it == queues.end()) return -1;
+        Queue& q = it->second;
+        int promoted = -1;
+        while (promoted < 0) {
+            dropStaleFront(q);
+            if (q.order.empty()) break;
+            int id = q.order.front().second;
+            q.order.pop_front();
+            q.ticket.erase(id);
+            if (eligible(id)) promoted = id;
+            else dropped.push_back(id);
+        }
+        if (q.ticket.empty()) queues.erase(it);
+        return promoted;
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                           ADMIN TRANSACTIONS                                ||
+// =================================================================================
+// Stages a batch of admin mutations in memory. GymManagement::commitTransaction
+// validates the whole batch in one pass and writes every affected file as one
+// set behind a commit journal, waiting for it. If validation or the write fails,
+// the in-memory tables are put back and nothing changes. A crash part-way
+// through the renames can leave a mix of old and new files, which the next
+// start completes from the journal, so the branch holds all of the set or none.
+struct AdminTransaction {
+    enum class OpType { DeleteTrainee, DeleteTrainer, DeleteClass };
+
+    struct Op {
+        OpType type;
+        int id;           // trainee or trainer id
+        string className; // for DeleteClass
+    };
+
+    vector<Op> ops;
+
+    void deleteTrainee(int id) { ops.push_back(Op{OpType::DeleteTrainee, id, ""}); }
+    void deleteTrainer(int id) { ops.push_back(Op{OpType::DeleteTrainer, id, ""}); }
+    void deleteClass(const string& className) { ops.push_back(Op{OpType::DeleteClass, 0, className}); }
+
+    bool empty() const { return ops.empty(); }
+    size_t size() const { return ops.size(); }
+};
+
+struct TransactionResult {
+    enum class Failure { None, NotFound, WriteFailed };
+
+    bool committed = false;
+    Failure failure = Failure::None;
+    string error;
+    int traineesRemoved = 0;
+    int trainersRemoved = 0;
+    int classesRemoved = 0;
+};
+// =================================================================================
+
+// =================================================================================
+// ||                             CREDENTIAL INDEX                                ||
+// =================================================================================
+enum class Role { Admin, Trainer, Trainee };
+
+// In-memory map from (role, username or id) to the stored password hash, so a
+// login is one hash lookup plus one PBKDF2 verification regardless of how many
+// members exist. Successful verifications are remembered for a short time (keyed
+// by a fast digest of hash + password) so repeat logins skip the slow hash.
+class CredentialStore {
+private:
+    struct Session {
+        string digest;
+        time_t expiresAt;
+    };
+
+    const int SESSION_TTL_SECONDS = 15 * 60;
+    unordered_map<string, string> hashes;
+    unordered_map<string, Session> sessions;
+    map<int, size_t> iterationLevels; // PBKDF2 iteration count -> stored hashes using it
+    map<int, string> dummies;         // throwaway hash per iteration count
+
+    static string keyFor(Role role, const string& identity) {
+        return to_string(static_cast<int>(role)) + ":" + identity;
+    }
+
+    static string sessionDigest(const string& stored, const string& password) {
+        return PasswordUtils::sha256(stored + '\0' + password);
+    }
+
+    void track(const string& stored, bool add) {
+        int level = PasswordUtils::iterationsOf(stored);
+        if (level <= 0) return;
+        if (add) {
+            iterationLevels[level]++;
+        } else if (--iterationLevels[level] == 0) {
+            iterationLevels.erase(level);
+        }
+    }
+
+    // Unknown users are verified against a throwaway hash with the iteration
+    // count most stored hashes use, so their timing matches a real account's
+    // even after imports or a change of GMS_HASH_ITERATIONS.
+    const string& dummyHash() {
+        int level = PasswordUtils::configuredIterations();
+        size_t most = 0;
+        for (const auto& entry : iterationLevels) {
+            if (entry.second >= most) {
+                most = entry.second;
+                level = entry.first;
+            }
+        }
+        // Well-formed but never derived: building it must not cost a PBKDF2 run
+        // of its own, or the first unknown login would still stand out.
+        auto it = dummies.find(level);
+        if (it == dummies.end()) {
+            string hash = PasswordUtils::HASH_PREFIX + to_string(level) + "$" + PasswordUtils::toHex(PasswordUtils::randomSalt()) +
+                          "$" + string(64, '0');
+            it = dummies.emplace(level, hash).first;
+        }
+        return it->second;
+    }
+
+public:
+    void clear() {
+        hashes.clear();
+        sessions.clear();
+        iterationLevels.clear();
+    }
+
+    void put(Role role, const string& identity, const string& storedHash) {
+        string key = keyFor(role, identity);
+        auto it = hashes.find(key);
+        if (it != hashes.end()) track(it->second, false);
+        hashes[key] = storedHash;
+        track(storedHash, true);
+        sessions.erase(key);
+    }
+
+    void erase(Role role, const string& identity) {
+        string key = keyFor(role, identity);
+        auto it = hashes.find(key);
+        if (it != hashes.end()) {
+            track(it->second, false);
+            hashes.erase(it);
+        }
+        sessions.erase(key);
+    }
+
+    bool verify(Role role, const string& identity, const string& password) {
+        string key = keyFor(role, identity);
+        auto it = hashes.find(key);
+        if (it == hashes.end()) {
+            PasswordUtils::verifyPassword(password, dummyHash());
+            return false;
+        }
+
+        time_t now = time(nullptr);
+        string digest = sessionDigest(it->second, password);
+        auto session = sessions.find(key);
+        if (session != sessions.end() && session->second.expiresAt > now &&
+            PasswordUtils::constantTimeEquals(session->second.digest, digest)) {
+            return true;
+        }
+
+        if (!PasswordUtils::verifyPassword(password, it->second)) return false;
+        sessions[key] = Session{digest, now + SESSION_TTL_SECONDS};
+        return true;
+    }
+
+    bool contains(Role role, const string& identity) const { return hashes.count(keyFor(role, identity)) > 0; }
+
+    // Iteration count of the stored hash; 0 if the account is unknown.
+    int iterationsFor(Role role, const string& identity) const {
+        auto it = hashes.find(keyFor(role, identity));
+        return it == hashes.end() ? 0 : PasswordUtils::iterationsOf(it->second);
+    }
+
+    size_t size() const { return hashes.size(); }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                       CHANGE-DATA-CAPTURE FEED                              ||
+// =================================================================================
+struct ChangeRecord {
+    uint64_t sequence = 0;
+    int64_t timestamp = 0;
+    string table;   // "trainee", "trainer", "class" or "enrollment"
+    string op;      // "insert", "update" or "delete"
+    string key;     // record id, class name, or "className:traineeId" for enrollments
+    string payload; // the record's file line after the change, password left empty; empty for deletes
+};
+
+// Append-only, sequence-numbered log of every data change for one branch.
+// Lines are "seq<TAB>timestamp<TAB>table<TAB>op<TAB>key<TAB>payload". A consumer
+// keeps a checkpoint (last sequence + byte offset) and resumes by seeking
+// straight to that offset, so an incremental sync reads only the new records.
+class ChangeFeed {
+private:
+    const string FEED_FILE;
+    mutex feedMutex;
+    uint64_t lastSequence = 0;
+    string unwritten; // formatted records of a failed append, written ahead of the next batch
+    string lastError;
+
+    // Appends `batch` whole or not at all: bytes of a failed write are cut off again.
+    bool appendToFile(const string& batch) {
+        error_code ec;
+        uintmax_t before = filesystem::exists(FEED_FILE, ec) ? filesystem::file_size(FEED_FILE, ec) : 0;
+        if (ec) return false;
+        {
+            ofstream out(FEED_FILE, ios::binary | ios::app);
+            if (out) {
+                out.write(batch.data(), batch.size());
+                out.flush();
+                if (out.good()) return true;
+            }
+        }
+        if (filesystem::exists(FEED_FILE, ec)) filesystem::resize_file(FEED_FILE, before, ec);
+        return false;
+    }
+
+    static void formatInto(string& out, const ChangeRecord& r) {
+        out += to_string(r.sequence);
+        out += '\t';
+        out += to_string(r.timestamp);
+        out += '\t';
+        out += r.table;
+        out += '\t';
+        out += r.op;
+        out += '\t';
+        out += r.key;
+        out += '\t';
+        out += r.payload;
+        out += '\n';
+    }
+
+    static bool parse(const string& line, ChangeRecord& r) {
+        stringstream ss(line);
+        string item;
+        try {
+            getline(ss, item, '\t'); r.sequence = stoull(item);
+            getline(ss, item, '\t'); r.timestamp = stoll(item);
+            getline(ss, r.table, '\t');
+            getline(ss, r.op, '\t');
+            getline(ss, r.key, '\t');
+            getline(ss, r.payload);
+        } catch (const exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    string checkpointFile(const string& consumer) const { return FEED_FILE + "." + consumer + ".ckpt"; }
+
+    // Recovers the last sequence number from the end of the feed, reading
+    // backwards in growing windows until a whole line parses. A torn final
+    // append (no newline) is cut off so the next record starts on its own line;
+    // an unreadable line is skipped. A feed with content but no readable line is
+    // reported: restarting at 1 would hide every new record behind the
+    // consumers' checkpoints.
+    void recoverLastSequence() {
+        streamoff size = 0;
+        streamoff wholeEnd = -1; // end of the last '\n'-terminated line
+        {
+            ifstream in(FEED_FILE, ios::binary | ios::ate);
+            if (!in) return;
+            size = in.tellg();
+            for (streamoff window = 4096;; window *= 4) {
+                streamoff tail = min(size, window);
+                in.seekg(size - tail);
+                string buffer(static_cast<size_t>(tail), '\0');
+                in.read(&buffer[0], tail);
+
+                size_t newline = buffer.find_last_of('\n');
+                if (wholeEnd < 0 && (newline != string::npos || tail == size)) {
+                    wholeEnd = (newline == string::npos) ? 0 : size - tail + static_cast<streamoff>(newline) + 1;
+                }
+                // Only lines that start inside the window are whole.
+                size_t first = 0;
+                if (tail < size) {
+                    first = buffer.find('\n');
+                    first = (first == string::npos) ? buffer.size() : first + 1;
+                }
+                while (newline != string::npos && newline >= first && lastSequence == 0) {
+                    size_t previous = (newline == 0) ? string::npos : buffer.find_last_of('\n', newline - 1);
+                    size_t start = (previous == string::npos) ? 0 : previous + 1;
+                    if (start < first) break;
+                    ChangeRecord last;
+                    if (parse(buffer.substr(start, newline - start), last) && last.sequence > 0) lastSequence = last.sequence;
+                    newline = previous;
+                }
+                if (lastSequence > 0 || tail == size) break;
+            }
+        }
+        if (wholeEnd >= 0 && wholeEnd < size) {
+            error_code ec;
+            filesystem::resize_file(FEED_FILE, static_cast<uintmax_t>(wholeEnd), ec);
+            if (!ec) cerr << "Warning: dropped an incomplete record at the end of " << FEED_FILE << "\n";
+        }
+        if (lastSequence == 0 && size > 0) {
+            cerr << "Warning: no readable record in " << FEED_FILE
+                 << "; change sequence numbers restart at 1 and feed consumers must reset their checkpoints\n";
+        }
+    }
+
+public:
+    struct Checkpoint {
+        uint64_t sequence = 0;
+        streamoff offset = 0;
+    };
+
+    explicit ChangeFeed(const string& feedFile) : FEED_FILE(feedFile) { recoverLastSequence(); }
+
+    // Assigns sequence numbers and appends every record with a single write.
+    void append(vector<ChangeRecord> records) {
+        if (records.empty()) return;
+        lock_guard<mutex> lock(feedMutex);
+        int64_t now = static_cast<int64_t>(time(nullptr));
+        size_t bytes = 0;
+        for (const auto& r : records) bytes += r.table.size() + r.op.size() + r.key.size() + r.payload.size() + 48;
+        string batch = move(unwritten);
+        unwritten.clear();
+        batch.reserve(batch.size() + bytes);
+        for (auto& r : records) {
+            r.sequence = ++lastSequence;
+            r.timestamp = now;
+            formatInto(batch, r);
+        }
+        if (appendToFile(batch)) return;
+        // Keep the records (and their sequence numbers) for the next append.
+        unwritten = move(batch);
+        lastError = "could not append to " + FEED_FILE + "; the change records are retried with the next change";
+        cerr << "Error: " << lastError << "\n";
+    }
+
+    // The error of an append that failed since the last check, or "".
+    string takeError() {
+        lock_guard<mutex> lock(feedMutex);
+        string error = move(lastError);
+        lastError.clear();
+        return error;
+    }
+
+    void record(const string& table, const string& op, const string& key, const string& payload = "") {
+        ChangeRecord r;
+        r.table = table;
+        r.op = op;
+        r.key = key;
+        r.payload = payload;
+        append({r});
+    }
+
+    uint64_t currentSequence() {
+        lock_guard<mutex> lock(feedMutex);
+        return lastSequence;
+    }
+
+    Checkpoint loadCheckpoint(const string& consumer) const {
+        Checkpoint checkpoint;
+        ifstream in(checkpointFile(consumer));
+        long long offset = 0;
+        if (in >> checkpoint.sequence >> offset) checkpoint.offset = static_cast<streamoff>(offset);
+        return checkpoint;
+    }
+
+    bool saveCheckpoint(const string& consumer, const Checkpoint& checkpoint) const {
+        string error;
+        return FileUtils::replaceFilesAtomically(
+            {{checkpointFile(consumer), to_string(checkpoint.sequence) + " " + to_string(static_cast<long long>(checkpoint.offset)) + "\n"}},
+            error);
+    }
+
+    // Returns up to `limit` records after the consumer's checkpoint, plus the
+    // checkpoint to save once they have been processed. A checkpoint that points
+    // past the end of the file (feed was replaced) falls back to a scan that
+    // skips already-seen sequence numbers.
+    vector<ChangeRecord> readSince(const Checkpoint& from, size_t limit, Checkpoint& next) {
+        lock_guard<mutex> lock(feedMutex);
+        vector<ChangeRecord> records;
+        next = from;
+        ifstream in(FEED_FILE, ios::binary | ios::ate);
+        if (!in) return records;
+        streamoff size = in.tellg();
+        streamoff start = (from.offset <= size) ? from.offset : 0;
+        in.seekg(start);
+
+        string line;
+        streamoff position = start;
+        while (records.size() < limit && getline(in, line)) {
+            if (in.eof()) break; // partial trailing line, not yet complete
+            position += static_cast<streamoff>(line.size()) + 1;
+            ChangeRecord r;
+            if (!parse(line, r) || r.sequence <= from.sequence) continue;
+            records.push_back(r);
+            next.sequence = r.sequence;
+        }
+        next.offset = position;
+        return records;
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                              THREAD POOL                                    ||
+// =================================================================================
+// Fixed set of worker threads. Fans queries out across branches and serializes
+// the files of a multi-file save in parallel.
+class ThreadPool {
+private:
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex tasksMutex;
+    condition_variable tasksChanged;
+    bool stopping = false;
+
+    void workerLoop() {
+        while (true) {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(tasksMutex);
+                tasksChanged.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threadCount = max<size_t>(2, thread::hardware_concurrency())) {
+        for (size_t i = 0; i < threadCount; i++) workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(tasksMutex);
+            stopping = true;
+        }
+        tasksChanged.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    auto submit(F fn) -> future<decltype(fn())> {
+        auto task = make_shared<packaged_task<decltype(fn())()>>(move(fn));
+        auto result = task->get_future();
+        {
+            lock_guard<mutex> lock(tasksMutex);
+            tasks.push_back([task] { (*task)(); });
+        }
+        tasksChanged.notify_one();
+        return result;
+    }
+
+    size_t size() const { return workers.size(); }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                        BACKGROUND PERSISTENCE                               ||
+// =================================================================================
+// Saves return as soon as the in-memory table is updated. A flusher thread
+// serializes the snapshot it was handed and replaces the files afterwards. Each
+// queued write set is replaced atomically and in submission order; a set for
+// the same files as the newest queued one (not yet started) replaces it. The
+// queue is bounded, so a desk that outruns the disk waits for a free slot.
+// Work that must not run before the data is on disk (the change feed) is
+// queued behind the writes with afterQueuedWrites().
+class AsyncFlusher {
+public:
+    using Serializer = function<string()>;
+    using Callback = function<void()>;
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t coalesced = 0;
+        uint64_t written = 0;
+        uint64_t failed = 0;
+        double blockedSeconds = 0;
+    };
+
+private:
+    // Outcome of a set whose submitter waits for it (submitAndWait).
+    struct Completion {
+        bool done = false;
+        bool committed = false;
+        string error;
+    };
+
+    struct WriteSet {
+        vector<string> paths;
+        vector<Serializer> serializers;
+        vector<Callback> afterWrite;
+        shared_ptr<Completion> completion; // null for fire-and-forget saves
+    };
+
+    // Callbacks of a failed set, held until a later set covering the same files lands.
+    struct Deferred {
+        vector<string> paths;
+        vector<Callback> callbacks;
+    };
+
+    const size_t capacity;
+    deque<WriteSet> queue;
+    bool writing = false;
+    bool stopping = false;
+    vector<Callback> inFlightAfter; // callbacks of the set being written
+    vector<Deferred> deferred;
+    string lastError;
+    Stats counters;
+    mutex queueMutex;
+    condition_variable queueChanged;
+    thread worker;
+
+    static mutex& liveMutex() {
+        static mutex m;
+        return m;
+    }
+
+    static set<AsyncFlusher*>& live() {
+        static set<AsyncFlusher*> flushers;
+        return flushers;
+    }
+
+    // Shared by every flusher; sized to the machine, not to the number of branches.
+    static ThreadPool& serializerPool() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Files of one set are serialized concurrently on the shared pool; the first on this thread.
+    static vector<pair<string, string>> serialize(WriteSet& set) {
+        vector<future<string>> pending;
+        for (size_t i = 1; i < set.serializers.size(); i++) pending.push_back(serializerPool().submit(set.serializers[i]));
+        vector<pair<string, string>> files;
+        files.push_back({set.paths[0], set.serializers[0]()});
+        for (size_t i = 1; i < set.paths.size(); i++) files.push_back({set.paths[i], pending[i - 1].get()});
+        return files;
+    }
+
+    void run() {
+        unique_lock<mutex> lock(queueMutex);
+        while (true) {
+            queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            WriteSet set = move(queue.front());
+            queue.pop_front();
+            writing = true;
+            inFlightAfter = move(set.afterWrite);
+            queueChanged.notify_all();
+            lock.unlock();
+
+            string error;
+            bool committed = false;
+            bool ok = false;
+            try {
+                ok = FileUtils::replaceFilesAtomically(serialize(set), error, committed);
+            } catch (const exception& e) {
+                error = string("could not serialize ") + set.paths[0] + ": " + e.what();
+            }
+            // A waiting submitter reports a set that never committed itself.
+            bool reportHere = !ok && (!set.completion || committed);
+            if (reportHere) cerr << "Error: background save failed: " << error << "\n";
+
+            lock.lock();
+            if (ok) {
+                counters.written++;
+            } else {
+                counters.failed++;
+                if (reportHere) lastError = error;
+            }
+            if (set.completion) {
+                set.completion->done = true;
+                set.completion->committed = committed;
+                set.completion->error = error;
+            }
+            // Callbacks added while the set was in flight belong to it too, so
+            // keep draining until none arrive; `writing` stays set meanwhile.
+            vector<Callback> landed = ok ? takeDeferredCoveredBy(set.paths) : vector<Callback>();
+            while (true) {
+                vector<Callback> pending = move(inFlightAfter);
+                inFlightAfter.clear();
+                if (!ok) {
+                    deferCallbacks(set.paths, move(pending));
+                    break;
+                }
+                landed.insert(landed.end(), make_move_iterator(pending.begin()), make_move_iterator(pending.end()));
+                if (landed.empty()) break;
+                lock.unlock();
+                for (auto& fn : landed) fn();
+                landed.clear();
+                lock.lock();
+            }
+            writing = false;
+            queueChanged.notify_all();
+        }
+    }
+
+    void deferCallbacks(const vector<string>& paths, vector<Callback> callbacks) {
+        if (callbacks.empty()) return;
+        if (deferred.empty() || deferred.back().paths != paths) deferred.push_back({paths, {}});
+        vector<Callback>& held = deferred.back().callbacks;
+        held.insert(held.end(), make_move_iterator(callbacks.begin()), make_move_iterator(callbacks.end()));
+    }
+
+    // A full save of a superset of a failed set's files also carries its changes.
+    vector<Callback> takeDeferredCoveredBy(const vector<string>& paths) {
+        vector<Callback> ready;
+        for (auto it = deferred.begin(); it != deferred.end();) {
+            bool covered = all_of(it->paths.begin(), it->paths.end(),
+                                  [&paths](const string& p) { return find(paths.begin(), paths.end(), p) != paths.end(); });
+            if (!covered) {
+                ++it;
+                continue;
+            }
+            ready.insert(ready.end(), make_move_iterator(it->callbacks.begin()), make_move_iterator(it->callbacks.end()));
+            it = deferred.erase(it);
+        }
+        return ready;
+    }
+
+public:
+    explicit AsyncFlusher(size_t maxQueued = 8) : capacity(max<size_t>(1, maxQueued)) {
+        static once_flag registered;
+        call_once(registered, [] {
+            // Built before registering so they are destroyed after flushAll runs.
+            liveMutex();
+            live();
+            serializerPool();
+            atexit(flushAll);
+        });
+        {
+            lock_guard<mutex> lock(liveMutex());
+            live().insert(this);
+        }
+        worker = thread(&AsyncFlusher::run, this);
+    }
+
+    ~AsyncFlusher() {
+        {
+            lock_guard<mutex> lock(liveMutex());
+            live().erase(this);
+        }
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        worker.join();
+    }
+
+    AsyncFlusher(const AsyncFlusher&) = delete;
+    AsyncFlusher& operator=(const AsyncFlusher&) = delete;
+
+    void submit(vector<pair<string, Serializer>> files) { enqueue(move(files), nullptr); }
+
+    // Queues the set like submit() and waits until it has been written. Returns
+    // true once the set has committed, i.e. the new files are on disk or will be
+    // completed from the journal on the next start; `error` is set whenever the
+    // write did not finish cleanly. On false no file was changed.
+    bool submitAndWait(vector<pair<string, Serializer>> files, string& error) {
+        error.clear();
+        if (files.empty()) return true;
+        shared_ptr<Completion> completion = make_shared<Completion>();
+        enqueue(move(files), completion);
+        unique_lock<mutex> lock(queueMutex);
+        queueChanged.wait(lock, [&completion] { return completion->done; });
+        error = completion->error;
+        return completion->committed;
+    }
+
+private:
+    void enqueue(vector<pair<string, Serializer>> files, shared_ptr<Completion> completion) {
+        if (files.empty()) return;
+        WriteSet set;
+        for (auto& f : files) {
+            set.paths.push_back(f.first);
+            set.serializers.push_back(move(f.second));
+        }
+        set.completion = move(completion);
+        unique_lock<mutex> lock(queueMutex);
+        counters.submitted++;
+        // A set someone waits for keeps its own outcome, so it is never merged.
+        if (!queue.empty() && queue.back().paths == set.paths && !queue.back().completion && !set.completion) {
+            vector<Callback>& earlier = queue.back().afterWrite;
+            set.afterWrite.insert(set.afterWrite.begin(), make_move_iterator(earlier.begin()), make_move_iterator(earlier.end()));
+            queue.back() = move(set);
+            counters.coalesced++;
+            return;
+        }
+        if (queue.size() >= capacity) {
+            auto started = chrono::steady_clock::now();
+            queueChanged.wait(lock, [this] { return queue.size() < capacity; });
+            counters.blockedSeconds += chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        }
+        queue.push_back(move(set));
+        queueChanged.notify_all();
+    }
+
+public:
+
+    // Runs `fn` once every write submitted so far has landed: after the newest
+    // queued set, after the one being written, or right away if none is pending.
+    // If that write fails, `fn` waits for the next successful save of the same
+    // files (each save writes the whole current table) and never runs otherwise.
+    void afterQueuedWrites(Callback fn) {
+        unique_lock<mutex> lock(queueMutex);
+        if (!queue.empty()) {
+            queue.back().afterWrite.push_back(move(fn));
+            return;
+        }
+        if (writing) {
+            inFlightAfter.push_back(move(fn));
+            return;
+        }
+        if (!deferred.empty()) { // the write it follows may be the one that failed
+            deferred.back().callbacks.push_back(move(fn));
+            return;
+        }
+        lock.unlock();
+        fn();
+    }
+
+    // The error of a write that failed since the last check, or "" (does not wait).
+    string takeError() {
+        lock_guard<mutex> lock(queueMutex);
+        string error = move(lastError);
+        lastError.clear();
+        return error;
+    }
+
+    // Waits until everything submitted so far is on disk. Returns false (with the
+    // error) if a write failed since the previous flush.
+    bool flush(string& error) {
+        unique_lock<mutex> lock(queueMutex);
+        queueChanged.wait(lock, [this] { return queue.empty() && !writing; });
+        error = lastError;
+        lastError.clear();
+        return error.empty();
+    }
+
+    Stats stats() {
+        lock_guard<mutex> lock(queueMutex);
+        return counters;
+    }
+
+    // Registered with atexit so exit() from any prompt still lands pending saves.
+    static void flushAll() {
+        lock_guard<mutex> lock(liveMutex());
+        for (AsyncFlusher* flusher : live()) {
+            string error;
+            flusher->flush(error);
+        }
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                      COPY-ON-WRITE TABLE SNAPSHOTS                          ||
+// =================================================================================
+// An immutable sequence that shares structure between versions. Records live
+// in chunks of up to CHUNK_SIZE behind shared pointers; changing one record
+// copies the chunk that holds it and the spine of chunk pointers, and every
+// other chunk is shared with the previous version. A version that someone
+// still holds (a report, a queued save) is never touched again.
+template <typename T>
+class PersistentVector {
+public:
+    static const size_t CHUNK_SIZE = 512;
+    static const size_t npos = static_cast<size_t>(-1);
+
+private:
+    typedef vector<T> Chunk;
+    vector<shared_ptr<const Chunk>> chunks; // never empty ones
+    vector<size_t> ends;                    // ends[c] = records in chunks 0..c
+
+    size_t chunkOf(size_t i) const { return static_cast<size_t>(upper_bound(ends.begin(), ends.end(), i) - ends.begin()); }
+    size_t chunkStart(size_t c) const { return c == 0 ? 0 : ends[c - 1]; }
+
+    void pushChunk(shared_ptr<const Chunk> chunk) {
+        ends.push_back(size() + chunk->size());
+        chunks.push_back(move(chunk));
+    }
+
+public:
+    class const_iterator {
+    private:
+        const PersistentVector* owner = nullptr;
+        size_t chunk = 0;
+        size_t offset = 0;
+
+    public:
+        const_iterator() {}
+        const_iterator(const PersistentVector* owner, size_t chunk) : owner(owner), chunk(chunk) {}
+        const T& operator*() const { return (*owner->chunks[chunk])[offset]; }
+        const T* operator->() const { return &**this; }
+        const_iterator& operator++() {
+            if (++offset == owner->chunks[chunk]->size()) {
+                chunk++;
+                offset = 0;
+            }
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return chunk == other.chunk && offset == other.offset; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+
+    PersistentVector() {}
+    explicit PersistentVector(vector<T> records) {
+        chunks.reserve((records.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        ends.reserve(chunks.capacity());
+        for (size_t start = 0; start < records.size(); start += CHUNK_SIZE) {
+            size_t end = min(records.size(), start + CHUNK_SIZE);
+            pushChunk(make_shared<const Chunk>(make_move_iterator(records.begin() + start),
+                                               make_move_iterator(records.begin() + end)));
+        }
+    }
+
+    size_t size() const { return ends.empty() ? 0 : ends.back(); }
+    bool empty() const { return ends.empty(); }
+    const T& operator[](size_t i) const {
+        size_t c = chunkOf(i);
+        return (*chunks[c])[i - chunkStart(c)];
+    }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, chunks.size()); }
+
+    vector<T> toVector() const {
+        vector<T> records;
+        records.reserve(size());
+        for (const auto& chunk : chunks) records.insert(records.end(), chunk->begin(), chunk->end());
+        return records;
+    }
+
+    template <typename Pred>
+    size_t indexOf(Pred pred) const {
+        for (size_t c = 0; c < chunks.size(); c++) {
+            const Chunk& chunk = *chunks[c];
+            for (size_t i = 0; i < chunk.size(); i++) {
+                if (pred(chunk[i])) return chunkStart(c) + i;
+            }
+        }
+        return npos;
+    }
+
+    // A new version with record `i` set to `value`.
+    PersistentVector replaced(size_t i, T value) const {
+        PersistentVector next(*this);
+        size_t c = chunkOf(i);
+        shared_ptr<Chunk> chunk = make_shared<Chunk>(*chunks[c]);
+        (*chunk)[i - chunkStart(c)] = move(value);
+        next.chunks[c] = move(chunk);
+        return next;
+    }
+
+    // A new version with `value` added at the end.
+    PersistentVector appended(T value) const {
+        PersistentVector next(*this);
+        if (chunks.empty() || chunks.back()->size() >= CHUNK_SIZE) {
+            shared_ptr<Chunk> chunk = make_shared<Chunk>();
+            chunk->reserve(CHUNK_SIZE);
+            chunk->push_back(move(value));
+            next.pushChunk(move(chunk));
+        } else {
+            shared_ptr<Chunk> chunk = make_shared<Chunk>(*chunks.back());
+            chunk->push_back(move(value));
+            next.chunks.back() = move(chunk);
+            next.ends.back()++;
+        }
+        return next;
+    }
+
+    // A new version with `records` added at the end. Only the last chunk is
+    // copied (to fill it up); every full chunk is shared.
+    PersistentVector appendedAll(const vector<T>& records) const {
+        PersistentVector next(*this);
+        size_t i = 0;
+        if (!records.empty() && !chunks.empty() && chunks.back()->size() < CHUNK_SIZE) {
+            shared_ptr<Chunk> chunk = make_shared<Chunk>(*chunks.back());
+            size_t room = min(CHUNK_SIZE - chunk->size(), records.size());
+            chunk->insert(chunk->end(), records.begin(), records.begin() + room);
+            next.chunks.back() = move(chunk);
+            next.ends.back() += room;
+            i = room;
+        }
+        for (; i < records.size(); i += CHUNK_SIZE) {
+            size_t end = min(records.size(), i + CHUNK_SIZE);
+            next.pushChunk(make_shared<const Chunk>(records.begin() + i, records.begin() + end));
+        }
+        return next;
+    }
+
+    // A new version where apply(record) has run on every record matching `pred`.
+    // Chunks with no match are shared, as in erased().
+    template <typename Pred, typename Apply>
+    PersistentVector updated(Pred pred, Apply apply) const {
+        PersistentVector next(*this);
+        for (size_t c = 0; c < chunks.size(); c++) {
+            if (none_of(chunks[c]->begin(), chunks[c]->end(), pred)) continue;
+            shared_ptr<Chunk> chunk = make_shared<Chunk>(*chunks[c]);
+            for (auto& r : *chunk) {
+                if (pred(r)) apply(r);
+            }
+            next.chunks[c] = move(chunk);
+        }
+        return next;
+    }
+
+    // Calls fn(begin, end) for each range of positions whose records may differ
+    // from `older`: a chunk shared at the same position is skipped, a chunk
+    // rewritten in place (replaced) is one range, and once chunk boundaries move
+    // (appended, erased) everything from there to the end is.
+    template <typename F>
+    void forEachChangedRange(const PersistentVector& older, F fn) const {
+        for (size_t c = 0; c < chunks.size(); c++) {
+            bool sameSpan = c < older.chunks.size() && ends[c] == older.ends[c];
+            if (sameSpan && chunks[c] == older.chunks[c]) continue;
+            if (!sameSpan) {
+                fn(chunkStart(c), size());
+                return;
+            }
+            fn(chunkStart(c), ends[c]);
+        }
+    }
+
+    // A new version without the records matching `pred`. Chunks with no match
+    // are shared as they are, so deleting a few rows copies only their chunks.
+    template <typename Pred>
+    PersistentVector erased(Pred pred) const {
+        PersistentVector next;
+        next.chunks.reserve(chunks.size());
+        next.ends.reserve(chunks.size());
+        for (const auto& chunk : chunks) {
+            if (none_of(chunk->begin(), chunk->end(), pred)) {
+                next.pushChunk(chunk);
+                continue;
+            }
+            shared_ptr<Chunk> kept = make_shared<Chunk>();
+            for (const auto& r : *chunk) {
+                if (!pred(r)) kept->push_back(r);
+            }
+            if (!kept->empty()) next.pushChunk(move(kept));
+        }
+        return next;
+    }
+};
+
+// The key each resident table is looked up by.
+inline int rowKey(const Trainee& t) { return t.id; }
+inline int rowKey(const Trainer& t) { return t.id; }
+inline const string& rowKey(const GymClass& c) { return c.className; }
+
+// The authoritative copy of one data file once it has been read. Every save
+// publishes a new immutable version; snapshot() hands out the current one in
+// O(1), so a report or a queued write keeps a consistent view while the desk
+// moves on. Only the pointer swap is locked, never a reader's iteration.
+//
+// positionOf() answers key lookups on the current version from a hash index
+// that is built on first use and carried across publishes by re-reading only
+// the chunks that changed (one chunk for a replace or append). A shrinking
+// table drops it to be rebuilt. Older versions fall back to a scan.
+template <typename T>
+class ResidentTable {
+public:
+    typedef shared_ptr<const PersistentVector<T>> Version;
+    typedef typename decay<decltype(rowKey(declval<const T&>()))>::type Key;
+
+private:
+    mutable mutex versionMutex;
+    Version current;
+    mutable unordered_map<Key, size_t> positions; // of `current`, when `indexed`
+    mutable bool indexed = false;
+
+    // The first record with a key wins, as in a scan; entries left by records
+    // that have since moved or gone are overwritten or fail the check below.
+    void indexRange(const PersistentVector<T>& records, size_t begin, size_t end) const {
+        for (size_t i = begin; i < end; i++) {
+            auto slot = positions.emplace(rowKey(records[i]), i);
+            size_t& held = slot.first->second;
+            if (!slot.second && held > i) held = i;
+            else if (!slot.second && !(held < records.size() && rowKey(records[held]) == slot.first->first)) held = i;
+        }
+    }
+
+public:
+    bool loaded() const {
+        lock_guard<mutex> lock(versionMutex);
+        return current != nullptr;
+    }
+    Version snapshot() const {
+        lock_guard<mutex> lock(versionMutex);
+        return current;
+    }
+    void publish(PersistentVector<T> records) {
+        Version next = make_shared<const PersistentVector<T>>(move(records));
+        lock_guard<mutex> lock(versionMutex);
+        if (indexed && (!current || next->size() < current->size())) {
+            positions.clear();
+            indexed = false;
+        } else if (indexed) {
+            next->forEachChangedRange(*current, [&](size_t begin, size_t end) { indexRange(*next, begin, end); });
+        }
+        current.swap(next); // the old version is released after the lock, by `next`
+    }
+
+    // Position of the first record with `key` in `version`, or PersistentVector<T>::npos.
+    size_t positionOf(const Version& version, const Key& key) const {
+        {
+            lock_guard<mutex> lock(versionMutex);
+            if (version == current) {
+                if (!indexed) {
+                    positions.reserve(current->size());
+                    indexRange(*current, 0, current->size());
+                    indexed = true;
+                }
+                auto it = positions.find(key);
+                if (it == positions.end()) return PersistentVector<T>::npos;
+                if (it->second < current->size() && rowKey((*current)[it->second]) == key) return it->second;
+                // Stale entry (a duplicate key's record moved): scan below.
+            }
+        }
+        return version->indexOf([&key](const T& r) { return rowKey(r) == key; });
+    }
+};
+
+// One consistent cut across a branch's tables, taken together.
+struct TableSnapshot {
+    ResidentTable<Trainee>::Version trainees;
+    ResidentTable<Trainer>::Version trainers;
+    ResidentTable<GymClass>::Version classes;
+};
+// =================================================================================
+
+// =================================================================================
+// ||                          LAZY RECORD TABLES                                 ||
+// =================================================================================
+// Set GMS_LOAD_MODE=eager to parse whole files up front as before.
+bool lazyLoadingEnabled() {
+    static const bool enabled = [] {
+        const char* env = getenv("GMS_LOAD_MODE");
+        return !(env && string(env) == "eager");
+    }();
+    return enabled;
+}
+
+// Read-only view of one data file for short, read-mostly sessions. Opening it
+// only scans for newlines and records where each line starts, keyed by the
+// first field (the ID, or the name for classes). A record is decoded with
+// T::parse the first time it is asked for and kept in a small LRU cache. Lines
+// that fail validation are skipped with a warning, as loadRecords does; this
+// view never checks block CRCs, so every line is treated as unverified.
+// The index is rebuilt whenever the file's size or modification time changes.
+template <typename T>
+class LazyRecordTable {
+private:
+    typedef list<pair<string, T>> CacheList;
+
+    const string path;
+    const size_t cacheCapacity;
+
+    bool indexed = false;
+    uintmax_t indexedSize = 0;
+    filesystem::file_time_type indexedTime;
+    vector<pair<string, uint64_t>> offsets; // sorted by key, so a lookup is a binary search
+
+    CacheList cache; // most recently used first
+    unordered_map<string, typename CacheList::iterator> cached;
+
+    void addLine(uint64_t start, uint64_t end, const string& key) {
+        if (end == start || DataFormat::isMetaLine(key)) return; // blank line, header or block trailer
+        offsets.emplace_back(key, start);
+    }
+
+    void buildIndex() {
+        offsets.clear();
+        cache.clear();
+        cached.clear();
+
+        ifstream file(path, ios::binary);
+        file.seekg(0, ios::end);
+        streamoff fileSize = file.tellg();
+        file.seekg(0, ios::beg);
+        if (fileSize > 0) offsets.reserve(static_cast<size_t>(fileSize / 64)); // rough guess at the row count
+        vector<char> buffer(1 << 16);
+        uint64_t base = 0, lineStart = 0;
+        string key;
+        bool keyDone = false;
+        while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+            size_t n = static_cast<size_t>(file.gcount());
+            const char* p = buffer.data();
+            const char* end = p + n;
+            while (p < end) {
+                const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+                const char* stop = newline ? newline : end;
+                if (!keyDone) {
+                    const char* comma = static_cast<const char*>(memchr(p, ',', stop - p));
+                    key.append(p, (comma ? comma : stop) - p);
+                    keyDone = (comma != nullptr);
+                }
+                if (!newline) break;
+                uint64_t lineEnd = base + (newline - buffer.data());
+                addLine(lineStart, lineEnd, key);
+                lineStart = lineEnd + 1;
+                key.clear();
+                keyDone = false;
+                p = newline + 1;
+            }
+            base += n;
+        }
+        addLine(lineStart, base, key); // final line without a trailing newline
+
+        // Files are usually written in key order already; the stable sort keeps the
+        // first of any duplicate keys in front, matching a linear search.
+        auto byKey = [](const pair<string, uint64_t>& a, const pair<string, uint64_t>& b) { return a.first < b.first; };
+        if (!is_sorted(offsets.begin(), offsets.end(), byKey)) stable_sort(offsets.begin(), offsets.end(), byKey);
+    }
+
+    void refreshIfChanged() {
+        error_code sizeError, timeError;
+        uintmax_t size = filesystem::file_size(path, sizeError);
+        filesystem::file_time_type mtime = filesystem::last_write_time(path, timeError);
+        if (sizeError || timeError) {
+            size = 0;
+            mtime = filesystem::file_time_type();
+        }
+        if (indexed && size == indexedSize && mtime == indexedTime) return;
+        buildIndex();
+        indexed = true;
+        indexedSize = size;
+        indexedTime = mtime;
+    }
+
+public:
+    explicit LazyRecordTable(const string& filePath, size_t capacity = 512)
+        : path(filePath), cacheCapacity(max<size_t>(capacity, 1)) {}
+
+    // Forces the next lookup to rescan, for writers whose change might not move the timestamp.
+    void invalidate() { indexed = false; }
+
+    size_t size() {
+        refreshIfChanged();
+        return offsets.size();
+    }
+
+    size_t cachedCount() const { return cache.size(); }
+
+    bool find(const string& key, T& out) {
+        refreshIfChanged();
+        auto hit = cached.find(key);
+        if (hit != cached.end()) {
+            cache.splice(cache.begin(), cache, hit->second);
+            out = hit->second->second;
+            return true;
+        }
+
+        auto offset = lower_bound(offsets.begin(), offsets.end(), key,
+                                  [](const pair<string, uint64_t>& entry, const string& k) { return entry.first < k; });
+        if (offset == offsets.end() || offset->first != key) return false;
+        ifstream file(path, ios::binary);
+        file.seekg(static_cast<streamoff>(offset->second));
+        string line;
+        if (!getline(file, line)) return false;
+        T record;
+        if (!T::parse(line, record)) {
+            cerr << "Warning: skipping malformed record in " << path << ": " << line << "\n";
+            return false;
+        }
+
+        cache.emplace_front(key, move(record));
+        cached[key] = cache.begin();
+        if (cache.size() > cacheCapacity) {
+            cached.erase(cache.back().first);
+            cache.pop_back();
+        }
+        out = cache.front().second;
+        return true;
+    }
+
+    // Streams the raw lines without decoding them; `fn` returns false to stop early.
+    template <typename F>
+    void forEachLine(F fn) const {
+        ifstream file(path);
+        string line;
+        while (getline(file, line)) {
+            if (!line.empty() && !DataFormat::isMetaLine(line) && !fn(line)) return;
+        }
+    }
+
+    // Decodes only the lines accepted by `predicate`; malformed ones are skipped.
+    template <typename F>
+    vector<T> decodeIf(F predicate) const {
+        vector<T> records;
+        forEachLine([&](const string& line) {
+            if (!predicate(line)) return true;
+            T record;
+            if (T::parse(line, record)) records.push_back(move(record));
+            else cerr << "Warning: skipping malformed record in " << path << ": " << line << "\n";
+            return true;
+        });
+        return records;
+    }
+
+    // Returns the index-th comma-separated field of a raw line ("" if missing).
+    static string field(const string& line, int index) {
+        size_t start = 0;
+        for (int i = 0; i < index; i++) {
+            start = line.find(',', start);
+            if (start == string::npos) return "";
+            start++;
+        }
+        size_t end = line.find(',', start);
+        return line.substr(start, end == string::npos ? string::npos : end - start);
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                        BULK CSV IMPORT & EXPORT                             ||
+// =================================================================================
+// Rows are parsed on worker threads in batches, with the same rules as the
+// interactive prompts. GymManagement then drops duplicate keys, hashes any
+// plaintext passwords and commits the accepted rows with one atomic write.
+namespace BulkCsv {
+
+    enum class Table { Trainees, Trainers, Classes };
+
+    const size_t BATCH_ROWS = 8192;
+
+    const char* tableName(Table table) {
+        switch (table) {
+            case Table::Trainees: return "trainees";
+            case Table::Trainers: return "trainers";
+            default: return "classes";
+        }
+    }
+
+    const char* header(Table table) {
+        switch (table) {
+            case Table::Trainees:
+                return "id,name,contact,password,package,duration_months,payment_status,height_m,weight_kg,"
+                       "membership_start,membership_expiry";
+            case Table::Trainers: return "id,name,specialization,contact,password";
+            default: return "class_name,schedule,trainer_name,capacity,duration_minutes";
+        }
+    }
+
+    // Accepts "trainees", "trainer", "Classes", ...
+    bool parseTable(string name, Table& out) {
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (!name.empty() && name.back() == 's') name.pop_back();
+        if (name == "trainee") out = Table::Trainees;
+        else if (name == "trainer") out = Table::Trainers;
+        else if (name == "class" || name == "classe") out = Table::Classes;
+        else return false;
+        return true;
+    }
+
+    struct Options {
+        int threads = static_cast<int>(max(2u, thread::hardware_concurrency()));
+        int hashIterations = PasswordUtils::configuredIterations();
+        string rejectsPath; // defaults to "<csv>.rejects.csv"
+    };
+
+    struct Reject {
+        size_t line;
+        string reason;
+        string row;
+    };
+
+    struct Report {
+        bool committed = false;
+        string error;
+        size_t rows = 0;
+        size_t imported = 0;
+        vector<Reject> rejects;
+        string rejectsPath;
+        double parseSeconds = 0;
+        double hashSeconds = 0;
+        double commitSeconds = 0;
+    };
+
+    // Records parsed from one batch of lines, in file order.
+    template <typename T>
+    struct Batch {
+        vector<T> records;
+        vector<size_t> lines;
+        vector<Reject> rejects;
+    };
+
+    // Runs fn(batchIndex) for every batch on up to `threads` threads.
+    template <typename Fn>
+    void forEachBatch(size_t batchCount, int threads, Fn fn) {
+        atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t b = next++; b < batchCount; b = next++) fn(b);
+        };
+        size_t workers = min<size_t>(static_cast<size_t>(max(threads, 1)), batchCount);
+        vector<thread> pool;
+        for (size_t i = 1; i < workers; i++) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+    }
+
+    // Splits one row. Fields may be double-quoted ("" is a literal quote) and are
+    // trimmed like prompt input. Returns false on a malformed quoted field.
+    bool splitRow(const char* p, const char* end, vector<string>& fields) {
+        fields.clear();
+        while (true) {
+            while (p < end && (*p == ' ' || *p == '\t')) p++;
+            string field;
+            if (p < end && *p == '"') {
+                for (p++;; p++) {
+                    if (p == end) return false;
+                    if (*p != '"') {
+                        field += *p;
+                    } else if (p + 1 < end && p[1] == '"') {
+                        field += '"';
+                        p++;
+                    } else {
+                        break;
+                    }
+                }
+                for (p++; p < end && (*p == ' ' || *p == '\t'); p++) {}
+                if (p < end && *p != ',') return false;
+            } else {
+                const char* start = p;
+                while (p < end && *p != ',') p++;
+                const char* last = p;
+                while (last > start && (last[-1] == ' ' || last[-1] == '\t')) last--;
+                field.assign(start, last);
+            }
+            fields.push_back(move(field));
+            if (p == end) return true;
+            p++;
+        }
+    }
+
+    string quote(const string& field) {
+        if (field.find_first_of(",\"") == string::npos && (field.empty() || (field.front() != ' ' && field.back() != ' '))) {
+            return field;
+        }
+        string quoted = "\"";
+        for (char ch : field) {
+            if (ch == '"') quoted += '"';
+            quoted += ch;
+        }
+        return quoted + "\"";
+    }
+
+    bool fail(string& error, const string& reason) {
+        error = reason;
+        return false;
+    }
+
+    // Data files separate fields with bare commas, so such a value could not be stored.
+    bool storable(const vector<string>& fields, string& error) {
+        for (const auto& f : fields) {
+            if (f.find(',') != string::npos) return fail(error, "Field '" + f + "' contains a comma");
+        }
+        return true;
+    }
+
+    bool equalsIgnoreCase(const string& a, const char* b) {
+        size_t n = strlen(b);
+        if (a.size() != n) return false;
+        for (size_t i = 0; i < n; i++) {
+            if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) return false;
+        }
+        return true;
+    }
+
+    bool parseId(const string& text, int& id, string& error) {
+        return (DataFormat::toInt(text, id) && id > 0) || fail(error, "ID must be a positive integer");
+    }
+
+    // Start and expiry for rows without dates, worked out once per import
+    // (the calendar arithmetic costs more than parsing the whole row).
+    struct MembershipDefaults {
+        int64_t start;
+        int64_t expiry3;
+        int64_t expiry6;
+
+        explicit MembershipDefaults(time_t now)
+            : start(static_cast<int64_t>(now)), expiry3(static_cast<int64_t>(ScheduleUtils::addMonths(now, 3))),
+              expiry6(static_cast<int64_t>(ScheduleUtils::addMonths(now, 6))) {}
+    };
+
+    // id,name,contact,password,package,duration_months[,payment_status,height_m,
+    // weight_kg,membership_start,membership_expiry]. Omitted dates start the
+    // membership today, as registration does.
+    bool parseTrainee(const vector<string>& f, const MembershipDefaults& defaults, Trainee& out, string& error) {
+        if (f.size() < 6 || f.size() > 11) return fail(error, "Expected 6 to 11 columns, found " + to_string(f.size()));
+        Trainee t;
+        if (!parseId(f[0], t.id, error)) return false;
+        if (f[1].empty()) return fail(error, "Name is empty");
+        error = InputUtils::contact_error(f[2]);
+        if (!error.empty()) return false;
+        if (f[3].empty()) return fail(error, "Password is empty");
+        if (equalsIgnoreCase(f[4], "Basic")) t.membership_package = "Basic";
+        else if (equalsIgnoreCase(f[4], "Premium")) t.membership_package = "Premium";
+        else return fail(error, "Package must be Basic or Premium");
+        if (!DataFormat::toInt(f[5], t.membership_duration_months) ||
+            (t.membership_duration_months != 3 && t.membership_duration_months != 6)) {
+            return fail(error, "Duration must be 3 or 6 months");
+        }
+        auto optional = [&f](size_t i) { return i < f.size() && !f[i].empty(); };
+        t.payment_status = "Paid";
+        if (optional(6)) {
+            if (equalsIgnoreCase(f[6], "Paid")) t.payment_status = "Paid";
+            else if (equalsIgnoreCase(f[6], "Due")) t.payment_status = "Due";
+            else return fail(error, "Payment status must be Paid or Due");
+        }
+        if ((optional(7) && (!DataFormat::toFloat(f[7], t.height_m) || t.height_m < 0)) ||
+            (optional(8) && (!DataFormat::toFloat(f[8], t.weight_kg) || t.weight_kg < 0))) {
+            return fail(error, "Height and weight must be non-negative numbers");
+        }
+        if ((optional(9) && !DataFormat::toInt64(f[9], t.membership_start)) ||
+            (optional(10) && !DataFormat::toInt64(f[10], t.membership_expiry))) {
+            return fail(error, "Membership dates must be Unix timestamps");
+        }
+        if (t.membership_start == 0) {
+            t.membership_start = defaults.start;
+            t.membership_expiry = t.membership_duration_months == 3 ? defaults.expiry3 : defaults.expiry6;
+        } else if (t.membership_expiry == 0) {
+            t.membership_expiry = static_cast<int64_t>(
+                ScheduleUtils::addMonths(static_cast<time_t>(t.membership_start), t.membership_duration_months));
+        }
+        t.name = f[1];
+        t.contact = f[2];
+        t.password = f[3];
+        out = move(t);
+        return true;
+    }
+
+    // id,name,specialization,contact,password
+    bool parseTrainer(const vector<string>& f, Trainer& out, string& error) {
+        if (f.size() != 5) return fail(error, "Expected 5 columns, found " + to_string(f.size()));
+        Trainer t;
+        if (!parseId(f[0], t.id, error)) return false;
+        if (f[1].empty()) return fail(error, "Name is empty");
+        if (f[2].empty()) return fail(error, "Specialization is empty");
+        error = InputUtils::contact_error(f[3]);
+        if (!error.empty()) return false;
+        if (f[4].empty()) return fail(error, "Password is empty");
+        t.name = f[1];
+        t.specialization = f[2];
+        t.contact = f[3];
+        t.password = f[4];
+        out = move(t);
+        return true;
+    }
+
+    // class_name,schedule,trainer_name,capacity[,duration_minutes]. Whether the
+    // trainer exists and is free is checked at commit time.
+    bool parseClass(const vector<string>& f, GymClass& out, string& error) {
+        if (f.size() != 4 && f.size() != 5) return fail(error, "Expected 4 or 5 columns, found " + to_string(f.size()));
+        GymClass c;
+        c.schedule = f[1];
+        if (f[0].empty()) return fail(error, "Class name is empty");
+        if (DataFormat::isMetaLine(f[0])) {
+            return fail(error, "Class name may not start with '" + DataFormat::HEADER_PREFIX + "' or '" + DataFormat::TRAILER_PREFIX + "'");
+        }
+        if (!InputUtils::normalize_schedule(c.schedule)) return fail(error, "Schedule must be Day-HH:MM (e.g. Mon-10:00)");
+        if (f[2].empty()) return fail(error, "Trainer name is empty");
+        if (!DataFormat::toInt(f[3], c.capacity) || c.capacity < 1 || c.capacity > 100) {
+            return fail(error, "Capacity must be between 1 and 100");
+        }
+        if (f.size() == 5 && !f[4].empty() &&
+            (!DataFormat::toInt(f[4], c.duration_minutes) || c.duration_minutes < ScheduleUtils::MIN_CLASS_MINUTES ||
+             c.duration_minutes > ScheduleUtils::MAX_CLASS_MINUTES)) {
+            return fail(error, "Duration must be between " + to_string(ScheduleUtils::MIN_CLASS_MINUTES) + " and " +
+                                   to_string(ScheduleUtils::MAX_CLASS_MINUTES) + " minutes");
+        }
+        c.className = f[0];
+        c.trainerName = f[2];
+        out = move(c);
+        return true;
+    }
+
+    string toCsv(const Trainee& t) {
+        return to_string(t.id) + "," + quote(t.name) + "," + t.contact + "," + t.password + "," + t.membership_package + "," +
+               to_string(t.membership_duration_months) + "," + t.payment_status + "," + to_string(t.height_m) + "," +
+               to_string(t.weight_kg) + "," + to_string(t.membership_start) + "," + to_string(t.membership_expiry);
+    }
+
+    string toCsv(const Trainer& t) {
+        return to_string(t.id) + "," + quote(t.name) + "," + quote(t.specialization) + "," + t.contact + "," + t.password;
+    }
+
+    string toCsv(const GymClass& c) {
+        return quote(c.className) + "," + c.schedule + "," + quote(c.trainerName) + "," + to_string(c.capacity) + "," +
+               to_string(c.duration_minutes);
+    }
+
+    template <typename T>
+    string exportRows(Table table, const vector<T>& records) {
+        string out = string(header(table)) + "\n";
+        for (const auto& r : records) out += toCsv(r) + "\n";
+        return out;
+    }
+
+    bool readFile(const string& path, string& text) {
+        ifstream file(path, ios::binary | ios::ate);
+        if (!file) return false;
+        text.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return static_cast<bool>(file.read(&text[0], static_cast<streamsize>(text.size())));
+    }
+
+    // Splits `text` into lines, skips blank lines and a header row (recognised by
+    // its first column), and parses the rest in batches on `threads` workers.
+    template <typename T, typename Parse>
+    vector<Batch<T>> parseParallel(const string& text, Table table, int threads, Parse parse, size_t& rows) {
+        struct LineRef {
+            size_t begin, end, number;
+        };
+        vector<LineRef> lines;
+        size_t number = 0;
+        for (size_t pos = 0; pos < text.size();) {
+            const char* nl = static_cast<const char*>(memchr(text.data() + pos, '\n', text.size() - pos));
+            size_t end = nl ? static_cast<size_t>(nl - text.data()) : text.size();
+            size_t trimmed = (end > pos && text[end - 1] == '\r') ? end - 1 : end;
+            number++;
+            if (text.find_first_not_of(" \t", pos) < trimmed) lines.push_back({pos, trimmed, number});
+            pos = end + 1;
+        }
+        if (!lines.empty()) {
+            string first = header(table);
+            first = first.substr(0, first.find(','));
+            vector<string> fields;
+            if (splitRow(text.data() + lines[0].begin, text.data() + lines[0].end, fields) && equalsIgnoreCase(fields[0], first.c_str())) {
+                lines.erase(lines.begin());
+            }
+        }
+        rows = lines.size();
+
+        vector<Batch<T>> batches((lines.size() + BATCH_ROWS - 1) / BATCH_ROWS);
+        forEachBatch(batches.size(), threads, [&](size_t b) {
+            Batch<T>& batch = batches[b];
+            vector<string> fields;
+            for (size_t i = b * BATCH_ROWS; i < min(lines.size(), (b + 1) * BATCH_ROWS); i++) {
+                const LineRef& line = lines[i];
+                string error = "Unterminated or malformed quoted field";
+                T record;
+                if (splitRow(text.data() + line.begin, text.data() + line.end, fields) && storable(fields, error) &&
+                    parse(fields, record, error)) {
+                    batch.records.push_back(move(record));
+                    batch.lines.push_back(line.number);
+                } else {
+                    batch.rejects.push_back({line.number, error, text.substr(line.begin, line.end - line.begin)});
+                }
+            }
+        });
+        return batches;
+    }
+
+    // Replaces every plaintext password with a hash; stored hashes are kept as is.
+    template <typename T>
+    void hashPasswords(vector<T>& records, int threads, int iterations) {
+        forEachBatch((records.size() + BATCH_ROWS - 1) / BATCH_ROWS, threads, [&](size_t b) {
+            for (size_t i = b * BATCH_ROWS; i < min(records.size(), (b + 1) * BATCH_ROWS); i++) {
+                if (!PasswordUtils::isHashed(records[i].password)) {
+                    records[i].password = PasswordUtils::hashPassword(records[i].password, iterations);
+                }
+            }
+        });
+    }
+
+    bool writeRejects(const string& path, const vector<Reject>& rejects) {
+        string out = "line,reason,row\n";
+        for (const auto& r : rejects) out += to_string(r.line) + "," + quote(r.reason) + "," + quote(r.row) + "\n";
+        return FileUtils::writeFile(path, out);
+    }
+
+    void printReport(Table table, const Report& report) {
+        if (!report.error.empty()) Console::print("Error: {}.\n", report.error);
+        Console::print("Imported {} of {} row(s) into {} in {:.2f} s (parse {:.2f} s, hashing {:.2f} s, commit {:.2f} s).\n",
+                       report.imported, report.rows, tableName(table),
+                       report.parseSeconds + report.hashSeconds + report.commitSeconds, report.parseSeconds,
+                       report.hashSeconds, report.commitSeconds);
+        if (!report.rejects.empty()) {
+            Console::print("{} row(s) rejected; see {}\n", report.rejects.size(), report.rejectsPath);
+            for (size_t i = 0; i < min<size_t>(report.rejects.size(), 5); i++) {
+                Console::print("  line {}: {}\n", report.rejects[i].line, report.rejects[i].reason);
+            }
+        }
+    }
+}
+// =================================================================================
+
+class GymManagement {
+private:
+    // Every branch keeps its own data files under DATA_DIR ("" for the main branch);
+    // admin accounts are shared by all branches.
+    const string DATA_DIR;
+    const string TRAINEE_FILE;
+    const string TRAINER_FILE;
+    const string CLASS_FILE;
+    const string ADMIN_FILE = "admins.txt";
+    const string CHECKIN_FILE;
+    const string CHANGE_FILE;
+    const string WAITLIST_FILE;
+
+    CheckInLog checkIns;
+    ChangeFeed changes;
+
+    // Lazily indexed views of the data files for the login and schedule paths,
+    // used until a table is first loaded into memory.
+    LazyRecordTable<Trainee> traineeTable;
+    LazyRecordTable<Trainer> trainerTable;
+    LazyRecordTable<GymClass> classTable;
+
+    // Authoritative once loaded; saves reach the files through `persistence`.
+    ResidentTable<Trainee> traineeRows;
+    ResidentTable<Trainer> trainerRows;
+    ResidentTable<GymClass> classRows;
+    AsyncFlusher persistence;
+
+    static int getCost(const string& package, int duration) {
+        if (package == "Basic") {
+            return (duration == 3) ? 100 : 180;
+        } else if (package == "Premium") {
+            return (duration == 3) ? 150 : 270;
+        }
+        return 0;
+    }
+
+    template <typename Records>
+    static string serializeRecords(const Records& records, const string& table) {
+        DataFormat::Writer writer(table, records.size());
+        for (const auto& r : records) writer.add(r.toString());
+        return writer.finish();
+    }
+
+    // Records in blocks whose checksum verified are decoded directly; anything
+    // else is validated field by field and dropped (with a warning) if malformed.
+    template <typename T>
+    static vector<T> loadRecords(const string& path) {
+        vector<T> records;
+        DataFormat::readRecords(path, [&](const string& line, bool verified) {
+            if (verified) {
+                records.push_back(T::fromString(line));
+                return;
+            }
+            T record;
+            if (T::parse(line, record)) records.push_back(record);
+            else cerr << "Warning: skipping malformed record in " << path << ": " << line << "\n";
+        });
+        return records;
+    }
+
+    // The current version of a table, read from disk the first time.
+    template <typename T>
+    typename ResidentTable<T>::Version resident(ResidentTable<T>& table, const string& path) {
+        if (!table.loaded()) table.publish(PersistentVector<T>(loadRecords<T>(path)));
+        return table.snapshot();
+    }
+
+    // A queued write of `snapshot`; it is serialized on the flusher thread.
+    template <typename Records>
+    static pair<string, AsyncFlusher::Serializer> pendingWrite(const string& path, shared_ptr<const Records> snapshot,
+                                                               const string& table) {
+        return {path, [snapshot, table] { return serializeRecords(*snapshot, table); }};
+    }
+
+    // Makes `next` the current version and queues it for the background writer.
+    template <typename T>
+    void publish(ResidentTable<T>& rows, PersistentVector<T> next, const string& path, const string& table) {
+        rows.publish(move(next));
+        persistence.submit({pendingWrite(path, rows.snapshot(), table)});
+    }
+
+    // Point lookup by ID: the resident table once loaded, otherwise the file index.
+    template <typename T>
+    static bool lookup(const ResidentTable<T>& rows, LazyRecordTable<T>& file, int id, T& out) {
+        typename ResidentTable<T>::Version records = rows.snapshot();
+        if (!records) return file.find(to_string(id), out);
+        size_t i = rows.positionOf(records, id);
+        if (i == PersistentVector<T>::npos) return false;
+        out = (*records)[i];
+        return true;
+    }
+
+    // --- Bulk import helpers ---
+    static double secondsSince(chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Walks the parsed batches in file order and keeps the first row for each key
+    // that is not already in the table (`seen` maps key -> line, 0 = existing).
+    // Rows that pass are also run through `check`, which returns a reject reason.
+    template <typename T, typename Key, typename KeyFn, typename Describe, typename Check>
+    static vector<T> acceptRows(vector<BulkCsv::Batch<T>>& batches, unordered_map<Key, size_t>& seen, KeyFn key,
+                                Describe describe, Check check, BulkCsv::Report& report) {
+        vector<T> accepted;
+        accepted.reserve(report.rows);
+        for (auto& batch : batches) {
+            report.rejects.insert(report.rejects.end(), batch.rejects.begin(), batch.rejects.end());
+            for (size_t i = 0; i < batch.records.size(); i++) {
+                T& record = batch.records[i];
+                auto slot = seen.emplace(key(record), batch.lines[i]);
+                string reason;
+                if (!slot.second) {
+                    reason = slot.first->second == 0 ? describe(record) + " already exists"
+                                                     : describe(record) + " duplicates line " + to_string(slot.first->second);
+                } else if (!(reason = check(record)).empty()) {
+                    seen.erase(slot.first);
+                }
+                if (reason.empty()) accepted.push_back(move(record));
+                else report.rejects.push_back({batch.lines[i], reason, BulkCsv::toCsv(record)});
+            }
+            batch = BulkCsv::Batch<T>();
+        }
+        return accepted;
+    }
+
+    // Appends the accepted rows and queues one atomic write of the table. The
+    // caller builds the change feed while the flusher serializes, then waits in
+    // finishImport so the report can say whether the write landed.
+    template <typename T>
+    bool commitImport(ResidentTable<T>& rows, const string& path, const string& table, const vector<T>& accepted) {
+        if (accepted.empty()) return false;
+        publish(rows, rows.snapshot()->appendedAll(accepted), path, table);
+        return true;
+    }
+
+    void finishImport(size_t accepted, BulkCsv::Report& report) {
+        if (accepted == 0 || !persistence.flush(report.error)) return;
+        report.imported = accepted;
+        report.committed = true;
+    }
+
+    void importTrainees(const string& text, const BulkCsv::Options& options, BulkCsv::Report& report) {
+        auto started = chrono::steady_clock::now();
+        BulkCsv::MembershipDefaults defaults(time(nullptr));
+        auto batches = BulkCsv::parseParallel<Trainee>(text, BulkCsv::Table::Trainees, options.threads,
+            [&defaults](const vector<string>& f, Trainee& t, string& error) { return BulkCsv::parseTrainee(f, defaults, t, error); },
+            report.rows);
+        ResidentTable<Trainee>::Version existing = resident(traineeRows, TRAINEE_FILE);
+        unordered_map<int, size_t> seen;
+        seen.reserve(existing->size() + report.rows);
+        for (const auto& t : *existing) seen.emplace(t.id, 0);
+        vector<Trainee> accepted = acceptRows(batches, seen, [](const Trainee& t) { return t.id; },
+                                              [](const Trainee& t) { return "ID " + to_string(t.id); },
+                                              [](const Trainee&) { return string(); }, report);
+        report.parseSeconds = secondsSince(started);
+
+        started = chrono::steady_clock::now();
+        BulkCsv::hashPasswords(accepted, options.threads, options.hashIterations);
+        report.hashSeconds = secondsSince(started);
+
+        started = chrono::steady_clock::now();
+        if (commitImport(traineeRows, TRAINEE_FILE, "trainees", accepted)) {
+            vector<ChangeRecord> feed;
+            feed.reserve(accepted.size());
+            for (const auto& t : accepted) {
+                feed.push_back(change("trainee", "insert", to_string(t.id), t.redactedString()));
+                if (credentialsReady) credentials.put(Role::Trainee, to_string(t.id), t.password);
+                if (expiryQueueReady && t.payment_status == "Paid") expiryQueue.schedule(t.id, t.membership_expiry);
+            }
+            logChanges(move(feed));
+        }
+        finishImport(accepted.size(), report);
+        report.commitSeconds = secondsSince(started);
+    }
+
+    void importTrainers(const string& text, const BulkCsv::Options& options, BulkCsv::Report& report) {
+        auto started = chrono::steady_clock::now();
+        auto batches = BulkCsv::parseParallel<Trainer>(text, BulkCsv::Table::Trainers, options.threads, BulkCsv::parseTrainer,
+                                                       report.rows);
+        ResidentTable<Trainer>::Version existing = resident(trainerRows, TRAINER_FILE);
+        unordered_map<int, size_t> seen;
+        seen.reserve(existing->size() + report.rows);
+        for (const auto& t : *existing) seen.emplace(t.id, 0);
+        vector<Trainer> accepted = acceptRows(batches, seen, [](const Trainer& t) { return t.id; },
+                                              [](const Trainer& t) { return "ID " + to_string(t.id); },
+                                              [](const Trainer&) { return string(); }, report);
+        report.parseSeconds = secondsSince(started);
+
+        started = chrono::steady_clock::now();
+        BulkCsv::hashPasswords(accepted, options.threads, options.hashIterations);
+        report.hashSeconds = secondsSince(started);
+
+        started = chrono::steady_clock::now();
+        if (commitImport(trainerRows, TRAINER_FILE, "trainers", accepted)) {
+            vector<ChangeRecord> feed;
+            feed.reserve(accepted.size());
+            for (const auto& t : accepted) {
+                feed.push_back(change("trainer", "insert", to_string(t.id), t.redactedString()));
+                if (credentialsReady) credentials.put(Role::Trainer, to_string(t.id), t.password);
+            }
+            logChanges(move(feed));
+        }
+        finishImport(accepted.size(), report);
+        report.commitSeconds = secondsSince(started);
+    }
+
+    // Like addClass, the trainer must exist and be free for the whole slot; rows
+    // are checked against the current schedule and the rows accepted before them.
+    void importClasses(const string& text, const BulkCsv::Options& options, BulkCsv::Report& report) {
+        auto started = chrono::steady_clock::now();
+        auto batches = BulkCsv::parseParallel<GymClass>(text, BulkCsv::Table::Classes, options.threads, BulkCsv::parseClass,
+                                                        report.rows);
+        unordered_set<string> trainerNames;
+        for (const auto& t : loadTrainers()) trainerNames.insert(t.name);
+        ensureScheduleIndex();
+        TrainerScheduleIndex pending = scheduleIndex;
+
+        ResidentTable<GymClass>::Version existing = resident(classRows, CLASS_FILE);
+        unordered_map<string, size_t> seen;
+        seen.reserve(existing->size() + report.rows);
+        for (const auto& c : *existing) seen.emplace(c.className, 0);
+        vector<GymClass> accepted = acceptRows(batches, seen, [](const GymClass& c) { return c.className; },
+            [](const GymClass& c) { return "Class '" + c.className + "'"; },
+            [&](const GymClass& c) {
+                if (!trainerNames.count(c.trainerName)) return "Trainer '" + c.trainerName + "' not found";
+                string clash = pending.findConflict(c.trainerName, ScheduleUtils::toMinuteOfWeek(c.schedule), c.duration_minutes);
+                if (!clash.empty()) return "Schedule conflict: " + c.trainerName + " already teaches '" + clash + "' during that slot";
+                pending.add(c);
+                return string();
+            },
+            report);
+        report.parseSeconds = secondsSince(started);
+
+        started = chrono::steady_clock::now();
+        if (commitImport(classRows, CLASS_FILE, "classes", accepted)) {
+            vector<ChangeRecord> feed;
+            feed.reserve(accepted.size());
+            for (const auto& c : accepted) {
+                feed.push_back(change("class", "insert", c.className, c.toString()));
+                onClassAdded(c);
+            }
+            logChanges(move(feed));
+        }
+        finishImport(accepted.size(), report);
+        report.commitSeconds = secondsSince(started);
+    }
+
+    // --- Change feed helpers ---
+    static ChangeRecord change(const string& table, const string& op, const string& key, string payload = "") {
+        ChangeRecord r;
+        r.table = table;
+        r.op = op;
+        r.key = key;
+        r.payload = move(payload);
+        return r;
+    }
+
+    static string enrollmentKey(const GymClass& c, int traineeId) { return c.className + ":" + to_string(traineeId); }
+
+    // Feed records follow the save queued for their change, so a consumer never
+    // reads a change that is not on disk yet. Call after publishing or saving.
+    void logChanges(vector<ChangeRecord> records) {
+        if (records.empty()) return;
+        persistence.afterQueuedWrites([this, records]() mutable { changes.append(move(records)); });
+    }
+
+    void logChange(const string& table, const string& op, const string& key, const string& payload = "") {
+        logChanges({change(table, op, key, payload)});
+    }
+
+    // --- In-memory indexes kept in step with every class mutation ---
+    TrainerScheduleIndex scheduleIndex;
+    bool scheduleIndexReady = false;
+
+    void ensureScheduleIndex() {
+        if (scheduleIndexReady) return;
+        scheduleIndex.clear();
+        for (const auto& c : loadClasses()) scheduleIndex.add(c);
+        scheduleIndexReady = true;
+    }
+
+    ScheduleViewCache scheduleView;
+    bool scheduleViewReady = false;
+
+    void ensureScheduleView() {
+        if (scheduleViewReady) return;
+        scheduleView.rebuild(loadClasses());
+        scheduleViewReady = true;
+    }
+
+    // Lazy mode builds only the requested day: just that day's class lines are decoded.
+    void ensureScheduleDay(int dayIndex) {
+        if (scheduleViewReady || scheduleView.isDayLoaded(dayIndex)) return;
+        if (!lazyLoadingEnabled() || classRows.loaded()) {
+            ensureScheduleView();
+            return;
+        }
+        const string& day = ScheduleUtils::WEEK_DAYS[dayIndex];
+        scheduleView.loadDay(dayIndex, classTable.decodeIf([&day](const string& line) {
+            return LazyRecordTable<GymClass>::field(line, 1).compare(0, day.size() + 1, day + "-") == 0;
+        }));
+    }
+
+    OccupancyAnalytics analytics;
+    bool analyticsReady = false;
+
+    void ensureAnalytics() {
+        if (analyticsReady) return;
+        analytics.rebuild(loadClasses());
+        analyticsReady = true;
+    }
+
+    TraineeEnrollmentIndex enrollmentIndex;
+    bool enrollmentIndexReady = false;
+
+    void ensureEnrollmentIndex() {
+        if (enrollmentIndexReady) return;
+        enrollmentIndex.clear();
+        for (const auto& c : *resident(classRows, CLASS_FILE)) enrollmentIndex.add(c);
+        enrollmentIndexReady = true;
+    }
+
+    // The view cache ignores days it has not loaded, so these run unconditionally.
+    void onClassAdded(const GymClass& c) {
+        if (scheduleIndexReady) scheduleIndex.add(c);
+        scheduleView.addClass(c);
+        if (analyticsReady) analytics.addClass(c);
+        if (enrollmentIndexReady) enrollmentIndex.add(c);
+    }
+
+    void onClassRemoved(const GymClass& c) {
+        if (scheduleIndexReady) scheduleIndex.remove(c);
+        scheduleView.removeClass(c);
+        if (analyticsReady) analytics.removeClass(c);
+        if (enrollmentIndexReady) enrollmentIndex.remove(c);
+    }
+
+    // Also covers capacity changes.
+    void onEnrollmentChanged(const GymClass& c) {
+        scheduleView.updateEnrollment(c);
+        if (analyticsReady) analytics.updateClass(c);
+        if (enrollmentIndexReady) enrollmentIndex.update(c);
+    }
+
+    MembershipExpiryQueue expiryQueue;
+    bool expiryQueueReady = false;
+
+    // Builds the expiry heap once; legacy records without dates are migrated to start today.
+    void ensureExpiryQueue() {
+        if (expiryQueueReady) return;
+        expiryQueue.clear();
+        if (lazyLoadingEnabled() && !traineeRows.loaded() && scheduleExpiriesFromRawLines()) {
+            expiryQueueReady = true;
+            return;
+        }
+        expiryQueue.clear();
+        vector<ChangeRecord> migrated;
+        PersistentVector<Trainee> trainees = resident(traineeRows, TRAINEE_FILE)->updated(
+            [](const Trainee& t) { return t.membership_expiry == 0; },
+            [&migrated](Trainee& t) {
+                t.startMembership(time(nullptr));
+                migrated.push_back(change("trainee", "update", to_string(t.id), t.redactedString()));
+            });
+        for (const auto& t : trainees) {
+            if (t.payment_status == "Paid") expiryQueue.schedule(t.id, t.membership_expiry);
+        }
+        if (!migrated.empty()) {
+            publish(traineeRows, move(trainees), TRAINEE_FILE, "trainees");
+            logChanges(migrated);
+        }
+        expiryQueueReady = true;
+    }
+
+    // Fills the heap from the id, status and expiry columns without decoding whole
+    // records. Returns false if a legacy record needs the full migration above.
+    bool scheduleExpiriesFromRawLines() {
+        bool complete = true;
+        traineeTable.forEachLine([this, &complete](const string& line) {
+            try {
+                int64_t expiry = stoll(LazyRecordTable<Trainee>::field(line, 10));
+                if (expiry == 0) throw invalid_argument("legacy record");
+                if (LazyRecordTable<Trainee>::field(line, 6) == "Paid") {
+                    expiryQueue.schedule(stoi(LazyRecordTable<Trainee>::field(line, 0)), expiry);
+                }
+                return true;
+            } catch (const exception&) {
+                complete = false;
+                return false;
+            }
+        });
+        return complete;
+    }
+
+    ClassWaitlists waitlists;
+    bool waitlistsReady = false;
+
+    void ensureWaitlists() {
+        if (waitlistsReady) return;
+        waitlists.load(loadRecords<WaitlistRecord>(WAITLIST_FILE));
+        waitlistsReady = true;
+    }
+
+    pair<string, AsyncFlusher::Serializer> pendingWaitlistWrite() const {
+        return pendingWrite(WAITLIST_FILE, make_shared<const vector<WaitlistRecord>>(waitlists.records()), "waitlists");
+    }
+
+    void saveWaitlists() { persistence.submit({pendingWaitlistWrite()}); }
+
+    bool eligibleForPromotion(int traineeId) {
+        Trainee t;
+        return findTrainee(traineeId, t) && t.membership_package == "Premium" && t.isMembershipActive(time(nullptr));
+    }
+
+    // Fills free seats in `c` from its waitlist (in memory; the caller saves).
+    // Returns true if the waitlist changed.
+    bool promoteWaitlisted(GymClass& c, vector<ChangeRecord>& feed) {
+        ensureWaitlists();
+        bool changed = false;
+        while (c.enrolledCount() < c.capacity && waitlists.size(c.className) > 0) {
+            vector<int> dropped;
+            int id = waitlists.popNext(c.className, [this](int traineeId) { return eligibleForPromotion(traineeId); }, dropped);
+            changed = true;
+            for (int d : dropped) feed.push_back(change("waitlist", "delete", enrollmentKey(c, d)));
+            if (id < 0) break;
+            c.enrolledTrainees.add(id);
+            feed.push_back(change("waitlist", "delete", enrollmentKey(c, id)));
+            feed.push_back(change("enrollment", "insert", enrollmentKey(c, id)));
+        }
+        return changed;
+    }
+
+    // Removes the given trainees from every class roster, handing their seats to
+    // the waitlists. Only the classes they are enrolled in are looked up and copied.
+    void revokeClassAccess(const vector<int>& traineeIds) {
+        ensureEnrollmentIndex();
+        ResidentTable<GymClass>::Version classes = resident(classRows, CLASS_FILE);
+        set<size_t> positions; // file order, as a full pass would visit them
+        for (int id : traineeIds) {
+            for (const auto& name : enrollmentIndex.classesOf(id)) {
+                size_t i = classRows.positionOf(classes, name);
+                if (i != PersistentVector<GymClass>::npos) positions.insert(i);
+            }
+        }
+        if (positions.empty()) return;
+
+        PersistentVector<GymClass> next = *classes;
+        vector<GymClass> touched;
+        vector<ChangeRecord> removals;
+        bool waitlistChanged = false;
+        for (size_t i : positions) {
+            GymClass c = (*classes)[i];
+            bool classChanged = false;
+            for (int id : traineeIds) {
+                if (c.enrolledTrainees.remove(id)) {
+                    classChanged = true;
+                    removals.push_back(change("enrollment", "delete", enrollmentKey(c, id)));
+                }
+            }
+            if (!classChanged) continue;
+            if (promoteWaitlisted(c, removals)) waitlistChanged = true;
+            next = next.replaced(i, c);
+            touched.push_back(move(c));
+        }
+        if (touched.empty()) return;
+        publish(classRows, move(next), CLASS_FILE, "classes");
+        if (waitlistChanged) saveWaitlists();
+        logChanges(removals);
+        for (const GymClass& c : touched) onEnrollmentChanged(c);
+    }
+
+    CredentialStore credentials;
+    bool credentialsReady = false;
+    bool credentialsComplete = false; // every account loaded, not just the ones used so far
+
+    vector<pair<string, string>> loadAdmins() {
+        vector<pair<string, string>> admins;
+        ifstream file(ADMIN_FILE);
+        string line;
+        while (getline(file, line)) {
+            stringstream ss(line);
+            string username, password;
+            getline(ss, username, ',');
+            getline(ss, password, ',');
+            if (!username.empty()) admins.push_back({username, password});
+        }
+        return admins;
+    }
+
+    // Written in place of the old file in one rename, like the data files, so a
+    // crash part-way through never leaves the gym without an admin account.
+    bool saveAdmins(const vector<pair<string, string>>& admins) {
+        string content;
+        for (const auto& a : admins) content += a.first + "," + a.second + "\n";
+        string error;
+        if (FileUtils::replaceFilesAtomically({{ADMIN_FILE, content}}, error)) return true;
+        cerr << "Error: " << error << "\n";
+        return false;
+    }
+
+    // Puts every admin's hash in the index, hashing (and saving) any that are
+    // still stored in plaintext.
+    void loadAdminCredentials() {
+        vector<pair<string, string>> admins = loadAdmins();
+        bool migrated = false;
+        for (auto& a : admins) {
+            if (!PasswordUtils::isHashed(a.second)) {
+                a.second = PasswordUtils::hashPassword(a.second);
+                migrated = true;
+            }
+            credentials.put(Role::Admin, a.first, a.second);
+        }
+        if (migrated) saveAdmins(admins);
+    }
+
+    // Builds the credential index once. Any password still stored in plaintext
+    // is hashed and written back, which migrates files from older versions.
+    // In lazy mode only admins are loaded here; trainer and trainee hashes are
+    // pulled in by verifyCredentials on first use.
+    void ensureCredentialIndex() {
+        if (credentialsReady) return;
+        credentials.clear();
+        loadAdminCredentials();
+        if (lazyLoadingEnabled() && !credentialsComplete) {
+            credentialsReady = true;
+            return;
+        }
+
+        vector<ChangeRecord> rehashed;
+        auto plaintext = [](const auto& account) { return !PasswordUtils::isHashed(account.password); };
+        PersistentVector<Trainer> trainers = resident(trainerRows, TRAINER_FILE)->updated(plaintext, [&rehashed](Trainer& t) {
+            t.password = PasswordUtils::hashPassword(t.password);
+            rehashed.push_back(change("trainer", "update", to_string(t.id), t.redactedString()));
+        });
+        for (const auto& t : trainers) credentials.put(Role::Trainer, to_string(t.id), t.password);
+        if (!rehashed.empty()) publish(trainerRows, move(trainers), TRAINER_FILE, "trainers");
+
+        size_t trainerUpdates = rehashed.size();
+        PersistentVector<Trainee> trainees = resident(traineeRows, TRAINEE_FILE)->updated(plaintext, [&rehashed](Trainee& t) {
+            t.password = PasswordUtils::hashPassword(t.password);
+            rehashed.push_back(change("trainee", "update", to_string(t.id), t.redactedString()));
+        });
+        for (const auto& t : trainees) credentials.put(Role::Trainee, to_string(t.id), t.password);
+        if (rehashed.size() > trainerUpdates) publish(traineeRows, move(trainees), TRAINEE_FILE, "trainees");
+        logChanges(rehashed);
+
+        credentialsReady = true;
+        credentialsComplete = true;
+    }
+
+    // Makes sure a trainer's or trainee's hash is in the index before it is checked.
+    void loadCredential(Role role, const string& identity) {
+        if (credentialsComplete || role == Role::Admin || credentials.contains(role, identity)) return;
+        int id;
+        if (!DataFormat::toInt(identity, id)) return;
+        string stored;
+        if (role == Role::Trainer) {
+            Trainer t;
+            if (!lookup(trainerRows, trainerTable, id, t)) return;
+            stored = t.password;
+        } else {
+            Trainee t;
+            if (!lookup(traineeRows, traineeTable, id, t)) return;
+            stored = t.password;
+        }
+        if (!PasswordUtils::isHashed(stored)) {
+            // A file from an older version: migrate everything in one pass.
+            credentialsReady = false;
+            credentialsComplete = true;
+            ensureCredentialIndex();
+            return;
+        }
+        credentials.put(role, identity, stored);
+    }
+
+public:
+    explicit GymManagement(const string& dataDir = "")
+        : DATA_DIR(dataDir), TRAINEE_FILE(dataDir + "trainees.txt"), TRAINER_FILE(dataDir + "trainers.txt"),
+          CLASS_FILE(dataDir + "classes.txt"), CHECKIN_FILE(dataDir + "checkins.log"),
+          CHANGE_FILE(dataDir + "changes.log"), WAITLIST_FILE(dataDir + "waitlists.txt"),
+          checkIns(CHECKIN_FILE), changes(CHANGE_FILE),
+          traineeTable(TRAINEE_FILE), trainerTable(TRAINER_FILE), classTable(CLASS_FILE) {
+        FileUtils::recoverInterruptedCommits(DATA_DIR, {TRAINEE_FILE, TRAINER_FILE, CLASS_FILE, WAITLIST_FILE});
+        initializeAdminFile();
+    }
+
+    void initializeAdminFile() {
+        if (!FileUtils::fileExists(ADMIN_FILE)) saveAdmins({{"admin", "admin123"}});
+    }
+
+    // --- Data Loading and Saving ---
+    // Tables are read from disk once; saves update memory and return while the
+    // flusher writes the file in the background. The save* calls replace a whole
+    // table (seeding a new branch); edits go through publish() with a version
+    // from replaced/appended/erased/updated so unchanged chunks stay shared.
+    vector<Trainee> loadTrainees() {
+        return resident(traineeRows, TRAINEE_FILE)->toVector();
+    }
+    void saveTrainees(const vector<Trainee>& trainees) {
+        publish(traineeRows, PersistentVector<Trainee>(trainees), TRAINEE_FILE, "trainees");
+    }
+    vector<Trainer> loadTrainers() { 
+        return resident(trainerRows, TRAINER_FILE)->toVector();
+    }
+    void saveTrainers(const vector<Trainer>& trainers) { 
+        publish(trainerRows, PersistentVector<Trainer>(trainers), TRAINER_FILE, "trainers");
+    }
+    vector<GymClass> loadClasses() { 
+        return resident(classRows, CLASS_FILE)->toVector();
+    }
+    void saveClasses(const vector<GymClass>& classes) { 
+        publish(classRows, PersistentVector<GymClass>(classes), CLASS_FILE, "classes");
+    }
+
+    // Point-in-time view for reports. Taking it is O(1) and needs the branch
+    // lock only for that moment; later saves publish new versions and never
+    // change the one handed out here.
+    TableSnapshot snapshot() {
+        TableSnapshot view;
+        view.trainees = resident(traineeRows, TRAINEE_FILE);
+        view.trainers = resident(trainerRows, TRAINER_FILE);
+        view.classes = resident(classRows, CLASS_FILE);
+        return view;
+    }
+
+    // Warns the desk about a background save, check-in or change-feed append that
+    // failed since the last menu, so it is not only on stderr. The next save of
+    // that table writes it in full, and unwritten feed records go out with the
+    // next change; check-ins that could not be appended are not counted.
+    void reportFailedSaves() {
+        string error = persistence.takeError();
+        if (!error.empty()) {
+            Console::print("\n*** Warning: a background save failed ({}). Recent changes may not be on disk yet; "
+                           "they are retried with the next save. ***\n", error);
+        }
+        string checkInError = checkIns.takeError();
+        if (!checkInError.empty()) Console::print("\n*** Warning: {}. ***\n", checkInError);
+        string feedError = changes.takeError();
+        if (!feedError.empty()) Console::print("\n*** Warning: {}. ***\n", feedError);
+    }
+
+    // Blocks until every queued save is on disk; reports a failed background write.
+    bool flushPersistence() {
+        string error;
+        if (persistence.flush(error)) return true;
+        cerr << "Error: " << error << "\n";
+        return false;
+    }
+
+    AsyncFlusher::Stats persistenceStats() { return persistence.stats(); }
+
+    static int getMembershipCost(const Trainee& t) {
+        return getCost(t.membership_package, t.membership_duration_months);
+    }
+
+    // --- User Registration and Management (ENHANCED) ---
+    void registerTrainee() {
+        Console::banner("REGISTER TRAINEE");
+        
+        int id;
+        while (true) {
+            id = InputUtils::get_numeric_input<int>("Enter new Trainee ID: ");
+            bool id_exists = traineeRows.positionOf(resident(traineeRows, TRAINEE_FILE), id) != PersistentVector<Trainee>::npos;
+            if (id_exists) {
+                cout << "Error: ID already exists. Please try a different ID.\n";
+            } else {
+                break;
+            }
+        }
+        
+        string name = InputUtils::get_non_empty_string("Enter Name: ");
+        string contact = InputUtils::get_contact_number("Enter Contact (10 digits): ");
+
+        cout << "--- Membership Packages ---\n";
+        cout << "1. Basic (Access to gym floor)\n";
+        cout << "2. Premium (Access to gym floor + all classes)\n";
+        int package_choice = InputUtils::get_numeric_input<int>("Choose package (1-2): ", 1, 2);
+        string package = (package_choice == 2) ? "Premium" : "Basic";
+
+        cout << "--- Membership Duration ---\n";
+        cout << "1. 3 Months\n";
+        cout << "2. 6 Months\n";
+        int duration_choice = InputUtils::get_numeric_input<int>("Choose duration (1-2): ", 1, 2);
+        int package_duration = (duration_choice == 2) ? 6 : 3;
+
+        int cost = getCost(package, package_duration);
+        Console::print("Total cost for {} membership for {} months is ${}.\n", package, package_duration, cost);
+        
+        if (!InputUtils::confirm_action("Confirm registration? (y/n): ")) {
+            cout << "Registration cancelled.\n";
+            return;
+        }
+
+        string password = InputUtils::get_hidden_password("Create Password: ");
+
+        Trainee newTrainee(id, name, contact, PasswordUtils::hashPassword(password), package, package_duration);
+        publish(traineeRows, resident(traineeRows, TRAINEE_FILE)->appended(newTrainee), TRAINEE_FILE, "trainees");
+        logChange("trainee", "insert", to_string(id), newTrainee.redactedString());
+        if (credentialsReady) credentials.put(Role::Trainee, to_string(id), newTrainee.password);
+        if (expiryQueueReady) expiryQueue.schedule(newTrainee.id, newTrainee.membership_expiry);
+        Console::print("Membership valid until {}.\n", ScheduleUtils::formatDate(static_cast<time_t>(newTrainee.membership_expiry)));
+        cout << "Trainee registered and payment confirmed successfully!\n";
+    }
+
+    void addTrainer() {
+        Console::banner("ADD TRAINER");
+        
+        int id;
+        while (true) {
+            id = InputUtils::get_numeric_input<int>("Enter Trainer ID: ");
+            bool id_exists = trainerRows.positionOf(resident(trainerRows, TRAINER_FILE), id) != PersistentVector<Trainer>::npos;
+            if (id_exists) {
+                 cout << "Error: ID already exists. Operation aborted.\n";
+            } else {
+                break;
+            }
+        }
+        
+        string name = InputUtils::get_non_empty_string("Enter Name: ");
+        string specialization = InputUtils::get_non_empty_string("Enter Specialization: ");
+        string contact = InputUtils::get_contact_number("Enter Contact (10 digits): ");
+        string password = InputUtils::get_hidden_password("Enter Password: ");
+
+        Trainer newTrainer(id, name, specialization, contact, PasswordUtils::hashPassword(password));
+        publish(trainerRows, resident(trainerRows, TRAINER_FILE)->appended(newTrainer), TRAINER_FILE, "trainers");
+        logChange("trainer", "insert", to_string(id), newTrainer.redactedString());
+        if (credentialsReady) credentials.put(Role::Trainer, to_string(id), newTrainer.password);
+        cout << "Trainer added successfully!\n";
+    }
+    
+    // --- Login Functions (ENHANCED) ---
+    bool verifyCredentials(Role role, const string& identity, const string& password) {
+        ensureCredentialIndex();
+        loadCredential(role, identity);
+        if (!credentials.verify(role, identity, password)) return false;
+        upgradeWeakHash(role, identity, password);
+        return true;
+    }
+
+    // A hash below the configured cost (a cheap bulk import, or an older
+    // GMS_HASH_ITERATIONS) is redone the first time the plaintext is at hand,
+    // which is a successful login. Stronger hashes are left alone.
+    void upgradeWeakHash(Role role, const string& identity, const string& password) {
+        int target = PasswordUtils::configuredIterations();
+        if (credentials.iterationsFor(role, identity) >= target) return;
+        string stronger = PasswordUtils::hashPassword(password, target);
+        if (role == Role::Admin) {
+            vector<pair<string, string>> admins = loadAdmins();
+            for (auto& a : admins) {
+                if (a.first == identity) a.second = stronger;
+            }
+            if (!saveAdmins(admins)) return; // keep checking against the hash that is on disk
+        } else if (role == Role::Trainer) {
+            ResidentTable<Trainer>::Version trainers = resident(trainerRows, TRAINER_FILE);
+            size_t i = trainerRows.positionOf(trainers, stoi(identity));
+            if (i == PersistentVector<Trainer>::npos) return;
+            Trainer t = (*trainers)[i];
+            t.password = stronger;
+            publish(trainerRows, trainers->replaced(i, t), TRAINER_FILE, "trainers");
+            logChange("trainer", "update", identity, t.redactedString());
+        } else {
+            ResidentTable<Trainee>::Version trainees = resident(traineeRows, TRAINEE_FILE);
+            size_t i = traineeRows.positionOf(trainees, stoi(identity));
+            if (i == PersistentVector<Trainee>::npos) return;
+            Trainee t = (*trainees)[i];
+            t.password = stronger;
+            publish(traineeRows, trainees->replaced(i, t), TRAINEE_FILE, "trainees");
+            logChange("trainee", "update", identity, t.redactedString());
+        }
+        credentials.put(role, identity, stronger);
+    }
+
+    bool adminLogin() {
+        Console::banner("ADMIN LOGIN");
+        string username = InputUtils::get_non_empty_string("Username: ");
+        string password = InputUtils::get_hidden_password("Password: ");
+        
+        if (verifyCredentials(Role::Admin, username, password)) {
+            cout << "Admin login successful!\n";
+            return true;
+        }
+        cout << "Invalid credentials!\n";
+        return false;
+    }
+
+    bool trainerLogin(Trainer& loggedInTrainer) {
+        Console::banner("TRAINER LOGIN");
+        int id = InputUtils::get_numeric_input<int>("Trainer ID: ");
+        string password = InputUtils::get_hidden_password("Password: ");
+        
+        if (!verifyCredentials(Role::Trainer, to_string(id), password)) {
+            cout << "Invalid credentials!\n";
+            return false;
+        }
+        if (findTrainer(id, loggedInTrainer)) {
+            cout << "Trainer login successful!\n";
+            return true;
+        }
+        cout << "Invalid credentials!\n";
+        return false;
+    }
+
+    bool traineeLogin(Trainee& loggedInTrainee) {
+        Console::banner("TRAINEE LOGIN");
+        int id = InputUtils::get_numeric_input<int>("Trainee ID: ");
+        string password = InputUtils::get_hidden_password("Password: ");
+        
+        if (!verifyCredentials(Role::Trainee, to_string(id), password)) {
+            cout << "Invalid credentials!\n";
+            return false;
+        }
+        processExpiredMemberships();
+        if (findTrainee(id, loggedInTrainee)) {
+            cout << "Login successful!\n";
+            return true;
+        }
+        cout << "Invalid credentials!\n";
+        return false;
+    }
+
+    // --- Class and Schedule Management (ENHANCED) ---
+    void addClass() {
+        Console::banner("ADD CLASS");
+        string className = InputUtils::get_non_empty_string("Enter Class Name (e.g., 'Leg Day', 'Yoga', 'HIIT'): ");
+        if (DataFormat::isMetaLine(className)) {
+            Console::print("Error: Class names may not start with '{}' or '{}'.\n", DataFormat::HEADER_PREFIX, DataFormat::TRAILER_PREFIX);
+            return;
+        }
+        // Rosters, waitlists and the analytics are all keyed by class name.
+        if (classRows.positionOf(resident(classRows, CLASS_FILE), className) != PersistentVector<GymClass>::npos) {
+            Console::print("Error: A class named '{}' already exists. Class not added.\n", className);
+            return;
+        }
+        string schedule = InputUtils::get_valid_schedule("Enter Schedule (Format: Day-HH:MM, e.g., 'Mon-10:00'): ");
+        int duration = promptClassDuration();
+        string trainerName = InputUtils::get_non_empty_string("Enter Trainer Name (must exist): ");
+        int capacity = InputUtils::get_numeric_input<int>("Enter Capacity: ", 1, 100);
+
+        ResidentTable<Trainer>::Version trainers = resident(trainerRows, TRAINER_FILE);
+        bool found = trainers->indexOf([&trainerName](const Trainer& t) { return t.name == trainerName; }) != PersistentVector<Trainer>::npos;
+        
+        if (!found) {
+            cout << "Trainer name not found! Class not added.\n";
+            return;
+        }
+
+        ensureScheduleIndex();
+        string clash = scheduleIndex.findConflict(trainerName, ScheduleUtils::toMinuteOfWeek(schedule), duration);
+        if (!clash.empty()) {
+            Console::print("Schedule conflict: {} already teaches '{}' during that slot. Class not added.\n", trainerName, clash);
+            return;
+        }
+        
+        GymClass newClass(className, schedule, trainerName, capacity, duration);
+        publish(classRows, resident(classRows, CLASS_FILE)->appended(newClass), CLASS_FILE, "classes");
+        logChange("class", "insert", className, newClass.toString());
+        onClassAdded(newClass);
+        cout << "Class added successfully!\n";
+    }
+
+    static int promptClassDuration() {
+        return InputUtils::get_numeric_input<int>("Enter Duration in minutes (" + to_string(ScheduleUtils::MIN_CLASS_MINUTES) + "-" +
+                                                      to_string(ScheduleUtils::MAX_CLASS_MINUTES) + "): ",
+                                                  ScheduleUtils::MIN_CLASS_MINUTES, ScheduleUtils::MAX_CLASS_MINUTES);
+    }
+
+    void displayFreeTrainers() {
+        Console::banner("FIND FREE TRAINERS");
+        string schedule = InputUtils::get_valid_schedule("Enter Slot (Format: Day-HH:MM, e.g., 'Tue-18:00'): ");
+        int duration = promptClassDuration();
+
+        vector<string> names;
+        for (const auto& t : loadTrainers()) names.push_back(t.name);
+        if (names.empty()) {
+            cout << "No trainers registered.\n";
+            return;
+        }
+
+        ensureScheduleIndex();
+        vector<string> freeNames = scheduleIndex.freeTrainers(names, ScheduleUtils::toMinuteOfWeek(schedule), duration);
+        if (freeNames.empty()) {
+            Console::print("No trainers are free at {}.\n", schedule);
+            return;
+        }
+        Console::print("Trainers free at {} for {} minutes:\n", schedule, duration);
+        for (const auto& name : freeNames) Console::print("  {}\n", name);
+    }
+
+    const string& weeklyScheduleScreen() {
+        ensureScheduleView();
+        return scheduleView.weekly();
+    }
+
+    // dayIndex: 0 = Mon ... 6 = Sun
+    const string& dailyScheduleScreen(int dayIndex) {
+        ensureScheduleDay(dayIndex);
+        return scheduleView.daily(dayIndex);
+    }
+
+    void displayWeeklySchedule() {
+        const string& screen = weeklyScheduleScreen();
+        cout.write(screen.data(), screen.size());
+    }
+
+    void displayDailySchedule() {
+        int today = ScheduleUtils::weekDayIndex(ScheduleUtils::localDayNumber(time(nullptr)));
+        const string& screen = dailyScheduleScreen(today);
+        cout.write(screen.data(), screen.size());
+    }
+
+    enum class SignUpResult { Enrolled, Waitlisted, AlreadyEnrolled, AlreadyWaitlisted, ClassNotFound, NotPremium, MembershipLapsed };
+    enum class WithdrawResult { Withdrawn, LeftWaitlist, NotEnrolled, ClassNotFound };
+
+    // Silent core of signUpForClass, shared by the menu and the replay tool.
+    SignUpResult enrollTrainee(const Trainee& trainee, const string& className) {
+        if (trainee.membership_package != "Premium") return SignUpResult::NotPremium;
+        if (!trainee.isMembershipActive(time(nullptr))) return SignUpResult::MembershipLapsed;
+
+        ResidentTable<GymClass>::Version classes = resident(classRows, CLASS_FILE);
+        size_t i = classRows.positionOf(classes, className);
+        if (i == PersistentVector<GymClass>::npos) return SignUpResult::ClassNotFound;
+        GymClass c = (*classes)[i];
+        if (c.isEnrolled(trainee.id)) return SignUpResult::AlreadyEnrolled;
+        if (c.enrolledCount() >= c.capacity) {
+            ensureWaitlists();
+            if (!waitlists.enqueue(c.className, trainee.id)) return SignUpResult::AlreadyWaitlisted;
+            saveWaitlists();
+            logChange("waitlist", "insert", enrollmentKey(c, trainee.id));
+            return SignUpResult::Waitlisted;
+        }
+
+        c.enrolledTrainees.add(trainee.id);
+        publish(classRows, classes->replaced(i, c), CLASS_FILE, "classes");
+        logChange("enrollment", "insert", enrollmentKey(c, trainee.id));
+        onEnrollmentChanged(c);
+        return SignUpResult::Enrolled;
+    }
+
+    void signUpForClass(Trainee& trainee, string className) {
+        processExpiredMemberships();
+        switch (enrollTrainee(trainee, className)) {
+            case SignUpResult::Enrolled:
+                Console::print("{} signed up successfully for {}!\n", trainee.name, className);
+                break;
+            case SignUpResult::AlreadyEnrolled:
+                cout << "You are already enrolled in this class.\n";
+                break;
+            case SignUpResult::Waitlisted:
+                Console::print("Class is full! You are number {} on the waitlist and will be enrolled automatically when a seat opens.\n",
+                               waitlistLength(className));
+                break;
+            case SignUpResult::AlreadyWaitlisted:
+                cout << "You are already on the waitlist for this class.\n";
+                break;
+            case SignUpResult::ClassNotFound:
+                cout << "Class not found!\n";
+                break;
+            case SignUpResult::NotPremium:
+                cout << "Class sign-up is a Premium feature. Please upgrade your membership.\n";
+                break;
+            case SignUpResult::MembershipLapsed:
+                cout << "Your membership has expired. Please renew it at the front desk.\n";
+                break;
+        }
+    }
+    
+    size_t waitlistLength(const string& className) {
+        ensureWaitlists();
+        return waitlists.size(className);
+    }
+
+    vector<WaitlistRecord> waitlistSnapshot() {
+        ensureWaitlists();
+        return waitlists.records();
+    }
+
+    // Gives up a seat (promoting the next waitlisted member) or a waitlist place.
+    WithdrawResult withdrawTrainee(int traineeId, const string& className) {
+        ResidentTable<GymClass>::Version classes = resident(classRows, CLASS_FILE);
+        size_t i = classRows.positionOf(classes, className);
+        if (i == PersistentVector<GymClass>::npos) return WithdrawResult::ClassNotFound;
+        GymClass c = (*classes)[i];
+        ensureWaitlists();
+        if (c.enrolledTrainees.remove(traineeId)) {
+            vector<ChangeRecord> feed{change("enrollment", "delete", enrollmentKey(c, traineeId))};
+            bool waitlistChanged = promoteWaitlisted(c, feed);
+            publish(classRows, classes->replaced(i, c), CLASS_FILE, "classes");
+            if (waitlistChanged) saveWaitlists();
+            logChanges(feed);
+            onEnrollmentChanged(c);
+            return WithdrawResult::Withdrawn;
+        }
+        if (waitlists.remove(c.className, traineeId)) {
+            saveWaitlists();
+            logChange("waitlist", "delete", enrollmentKey(c, traineeId));
+            return WithdrawResult::LeftWaitlist;
+        }
+        return WithdrawResult::NotEnrolled;
+    }
+
+    void withdrawFromClass(const Trainee& trainee, const string& className) {
+        switch (withdrawTrainee(trainee.id, className)) {
+            case WithdrawResult::Withdrawn:
+                Console::print("You have withdrawn from {}.\n", className);
+                break;
+            case WithdrawResult::LeftWaitlist:
+                Console::print("You have left the waitlist for {}.\n", className);
+                break;
+            case WithdrawResult::NotEnrolled:
+                cout << "You are not enrolled in or waiting for this class.\n";
+                break;
+            case WithdrawResult::ClassNotFound:
+                cout << "Class not found!\n";
+                break;
+        }
+    }
+
+    // Raising the capacity promotes waitlisted members into the new seats.
+    void updateClassCapacity() {
+        Console::banner("UPDATE CLASS CAPACITY");
+        string className = InputUtils::get_non_empty_string("Enter Class Name: ");
+        ResidentTable<GymClass>::Version classes = resident(classRows, CLASS_FILE);
+        size_t i = classRows.positionOf(classes, className);
+        if (i == PersistentVector<GymClass>::npos) {
+            cout << "Class not found!\n";
+            return;
+        }
+        GymClass c = (*classes)[i];
+        Console::print("Current capacity: {} ({} enrolled, {} waiting)\n", c.capacity, c.enrolledCount(), waitlistLength(className));
+        int capacity = InputUtils::get_numeric_input<int>("Enter new capacity: ", max(1, c.enrolledCount()), max(100, c.enrolledCount()));
+
+        // Sign-ups may have landed while the prompt was open; apply to the current record.
+        classes = resident(classRows, CLASS_FILE);
+        i = classRows.positionOf(classes, className);
+        if (i == PersistentVector<GymClass>::npos) {
+            cout << "Class was removed in the meantime. Capacity not changed.\n";
+            return;
+        }
+        c = (*classes)[i];
+        if (capacity < c.enrolledCount()) {
+            Console::print("{} members are now enrolled, more than {}. Capacity not changed.\n", c.enrolledCount(), capacity);
+            return;
+        }
+        c.capacity = capacity;
+        vector<ChangeRecord> feed;
+        int before = c.enrolledCount();
+        bool waitlistChanged = promoteWaitlisted(c, feed);
+        feed.insert(feed.begin(), change("class", "update", c.className, c.toString()));
+        publish(classRows, classes->replaced(i, c), CLASS_FILE, "classes");
+        if (waitlistChanged) saveWaitlists();
+        logChanges(feed);
+        onEnrollmentChanged(c);
+        Console::print("Capacity updated to {}.", capacity);
+        if (c.enrolledCount() > before) Console::print(" {} member(s) promoted from the waitlist.", c.enrolledCount() - before);
+        cout << "\n";
+    }
+
+    const OccupancyAnalytics& occupancy() {
+        ensureAnalytics();
+        return analytics;
+    }
+
+    // Weekly heatmap of enrolled/capacity per hour, trainer load and the
+    // fullest and emptiest classes, all read from the running aggregates.
+    void displayOccupancyAnalytics(size_t topN = 10) {
+        ensureAnalytics();
+        ensureWaitlists();
+        Console::banner("OCCUPANCY ANALYTICS");
+        if (analytics.classCount() == 0) {
+            cout << "No classes have been scheduled yet.\n";
+            return;
+        }
+
+        cout << "Occupancy % by hour (enrolled / capacity; '.' = no class)\n     ";
+        for (int hour = 0; hour < 24; hour++) Console::print("{:3}", hour);
+        cout << "\n";
+        for (int day = 0; day < 7; day++) {
+            Console::print("{}  ", ScheduleUtils::WEEK_DAYS[day]);
+            for (int hour = 0; hour < 24; hour++) {
+                const OccupancyAnalytics::Cell& cell = analytics.cell(day, hour);
+                if (cell.classes == 0 || cell.capacity <= 0) cout << "  .";
+                else Console::print("{:3}", (cell.enrolled * 100 + cell.capacity / 2) / cell.capacity);
+            }
+            cout << "\n";
+        }
+
+        cout << "\nTrainer utilization\n";
+        Console::print("{:<22}{:>9}{:>12}{:>11}{:>11}{:>8}\n", "  Trainer", "Classes", "Hours/week", "Enrolled", "Capacity", "Fill");
+        for (const auto& load : analytics.trainerLoads()) {
+            Console::print("  {:<20}{:9}{:12.1f}{:11}{:11}{:7}%\n", load.trainerName.substr(0, 19), load.classes,
+                           load.minutesPerWeek / 60.0, load.enrolled, load.capacity,
+                           load.capacity > 0 ? (load.enrolled * 100 + load.capacity / 2) / load.capacity : 0);
+        }
+
+        auto printClasses = [&](const string& title, const vector<OccupancyAnalytics::ClassFill>& list) {
+            Console::print("\n{}\n", title);
+            for (const auto& c : list) {
+                Console::print("  {:<24}{:<11}{:4}/{:<4}", c.className.substr(0, 23), c.schedule, c.enrolled, c.capacity);
+                size_t waiting = waitlists.size(c.className);
+                if (waiting > 0) Console::print("  +{} waiting", waiting);
+                cout << "\n";
+            }
+        };
+        printClasses("Top " + to_string(topN) + " fullest classes", analytics.fullest(topN));
+        printClasses("Top " + to_string(topN) + " emptiest classes", analytics.emptiest(topN));
+    }
+
+    // Times one hash at several PBKDF2 iteration counts (set GMS_HASH_ITERATIONS to change the default).
+    void benchmarkPasswordHashing() {
+        Console::banner("PASSWORD HASH BENCHMARK");
+        int configured = PasswordUtils::configuredIterations();
+        vector<int> costs = {1000, 5000, 10000, 50000};
+        if (find(costs.begin(), costs.end(), configured) == costs.end()) costs.push_back(configured);
+        sort(costs.begin(), costs.end());
+
+        for (int iterations : costs) {
+            auto start = chrono::steady_clock::now();
+            string hash = PasswordUtils::hashPassword("benchmark-password", iterations);
+            PasswordUtils::verifyPassword("benchmark-password", hash);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / 2;
+            Console::print("  {} iterations: {} ms per hash (~{} logins/sec per core){}\n", iterations, ms,
+                           static_cast<int>(ms > 0 ? 1000.0 / ms : 0), iterations == configured ? "  <- current" : "");
+        }
+    }
+
+    // Checks the block checksums of this branch's data files without loading them.
+    bool verifyDataFiles() {
+        Console::banner("VERIFY DATA FILES");
+        flushPersistence(); // check what is current, not what is still queued
+        return verifyFiles(DATA_DIR);
+    }
+
+    // Read-only check of the checksummed files under `dataDir`; usable without
+    // opening the branch, which would finish interrupted saves first.
+    static bool verifyFiles(const string& dataDir) {
+        bool allOk = true;
+        for (const char* name : {"trainees.txt", "trainers.txt", "classes.txt"}) {
+            DataFormat::VerifyReport report = DataFormat::verifyFile(dataDir + name);
+            DataFormat::printReport(report);
+            if (report.exists && report.header.present && !report.ok()) allOk = false;
+        }
+        cout << (allOk ? "No damaged blocks found.\n" : "Damage found; affected records are revalidated and malformed ones skipped on load.\n");
+        return allOk;
+    }
+
+    // Hands every change since the consumer's checkpoint to an export file and
+    // advances the checkpoint, so the warehouse only ever reads new records.
+    void exportChangeFeed() {
+        Console::banner("EXPORT CHANGE FEED");
+        string consumer = InputUtils::get_non_empty_string("Consumer name (e.g. 'warehouse'): ");
+        if (!all_of(consumer.begin(), consumer.end(), [](char ch) { return isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '-'; })) {
+            cout << "Error: Consumer names may only contain letters, digits, '-' and '_'.\n";
+            return;
+        }
+
+        flushPersistence(); // feed records are appended once their saves land
+        ChangeFeed::Checkpoint from = changes.loadCheckpoint(consumer);
+        ChangeFeed::Checkpoint next;
+        vector<ChangeRecord> records = changes.readSince(from, numeric_limits<size_t>::max(), next);
+        if (records.empty()) {
+            Console::print("No changes since sequence {}.\n", from.sequence);
+            return;
+        }
+
+        string exportFile = DATA_DIR + "changes." + consumer + ".export";
+        ofstream out(exportFile, ios::app);
+        for (const auto& r : records) {
+            out << r.sequence << "\t" << r.timestamp << "\t" << r.table << "\t" << r.op << "\t" << r.key << "\t" << r.payload << "\n";
+        }
+        out.close();
+        if (!out || !changes.saveCheckpoint(consumer, next)) {
+            cout << "Error: Could not write the export; checkpoint not advanced.\n";
+            return;
+        }
+        Console::print("Exported {} change(s) (sequence {} to {}) to {}.\n", records.size(), records.front().sequence,
+                       records.back().sequence, exportFile);
+    }
+
+    // --- Bulk CSV Import & Export ---
+    BulkCsv::Report importCsv(BulkCsv::Table table, const string& csvPath, const BulkCsv::Options& options = BulkCsv::Options()) {
+        BulkCsv::Report report;
+        report.rejectsPath = options.rejectsPath.empty() ? csvPath + ".rejects.csv" : options.rejectsPath;
+        string text;
+        if (!BulkCsv::readFile(csvPath, text)) {
+            report.error = "could not read " + csvPath;
+            return report;
+        }
+        if (table == BulkCsv::Table::Trainees) importTrainees(text, options, report);
+        else if (table == BulkCsv::Table::Trainers) importTrainers(text, options, report);
+        else importClasses(text, options, report);
+
+        sort(report.rejects.begin(), report.rejects.end(),
+             [](const BulkCsv::Reject& a, const BulkCsv::Reject& b) { return a.line < b.line; });
+        if (!report.rejects.empty() && !BulkCsv::writeRejects(report.rejectsPath, report.rejects) && report.error.empty()) {
+            report.error = "could not write " + report.rejectsPath;
+        }
+        return report;
+    }
+
+    bool exportCsv(BulkCsv::Table table, const string& csvPath, size_t& rows) {
+        string content;
+        if (table == BulkCsv::Table::Trainees) {
+            vector<Trainee> trainees = loadTrainees();
+            rows = trainees.size();
+            content = BulkCsv::exportRows(table, trainees);
+        } else if (table == BulkCsv::Table::Trainers) {
+            vector<Trainer> trainers = loadTrainers();
+            rows = trainers.size();
+            content = BulkCsv::exportRows(table, trainers);
+        } else {
+            vector<GymClass> classes = loadClasses();
+            rows = classes.size();
+            content = BulkCsv::exportRows(table, classes);
+        }
+        return FileUtils::writeFile(csvPath, content);
+    }
+
+    void bulkImportExport() {
+        Console::banner("BULK IMPORT / EXPORT");
+        cout << "1. Import from CSV\n";
+        cout << "2. Export to CSV\n";
+        int action = InputUtils::get_numeric_input<int>("Choose action (1-2): ", 1, 2);
+        cout << "1. Trainees\n";
+        cout << "2. Trainers\n";
+        cout << "3. Classes\n";
+        int choice = InputUtils::get_numeric_input<int>("Choose table (1-3): ", 1, 3);
+        BulkCsv::Table table = choice == 1 ? BulkCsv::Table::Trainees : choice == 2 ? BulkCsv::Table::Trainers : BulkCsv::Table::Classes;
+        string path = InputUtils::get_non_empty_string("CSV file path: ");
+
+        if (action == 2) {
+            size_t rows = 0;
+            if (exportCsv(table, path, rows)) Console::print("Exported {} row(s) from {} to {}.\n", rows, BulkCsv::tableName(table), path);
+            else Console::print("Error: could not write {}.\n", path);
+            return;
+        }
+        Console::print("Expected columns: {}\n", BulkCsv::header(table));
+        BulkCsv::printReport(table, importCsv(table, path));
+    }
+
+    // --- Enrollment Set Queries ---
+    void compareClassRosters() {
+        Console::banner("COMPARE CLASS ROSTERS");
+        string firstName = InputUtils::get_non_empty_string("Enter first Class Name: ");
+        string secondName = InputUtils::get_non_empty_string("Enter second Class Name: ");
+        cout << "1. Trainees in both classes\n";
+        cout << "2. Trainees in either class\n";
+        int mode = InputUtils::get_numeric_input<int>("Choose comparison (1-2): ", 1, 2);
+
+        const GymClass* first = nullptr;
+        const GymClass* second = nullptr;
+        vector<GymClass> classes = loadClasses();
+        for (const auto& c : classes) {
+            if (!first && c.className == firstName) first = &c;
+            if (!second && c.className == secondName) second = &c;
+        }
+        if (!first || !second) {
+            cout << "Class not found!\n";
+            return;
+        }
+
+        TraineeIdSet result = (mode == 1) ? TraineeIdSet::intersection(first->enrolledTrainees, second->enrolledTrainees)
+                                          : TraineeIdSet::unionOf(first->enrolledTrainees, second->enrolledTrainees);
+        if (result.empty()) {
+            cout << "No matching trainees.\n";
+            return;
+        }
+
         vector<Trainee> trainees = loadTrainees();
-        int id;
-        while (true) {
-            id = InputUtils::get_numeric_input<int>("Enter new Trainee ID: ");
-            bool id_exists = false;
-            for (const auto& t : trainees) {
-                if (t.id == id) {
-                    id_exists = true;
-                    break;
+        unordered_map<int, const Trainee*> byId;
+        for (const auto& t : trainees) byId[t.id] = &t;
+        Console::print("{} trainee(s):\n", result.size());
+        result.forEach([&byId](int id) {
+            auto it = byId.find(id);
+            Console::print("  ID: {}, Name: {}\n", id, it != byId.end() ? it->second->name : "(unknown)");
+        });
+    }
+
+    // --- Membership Expiry ---
+    // Flips lapsed memberships to "Due" and revokes their class enrollments.
+    // Cheap when nothing is due: only the top of the expiry heap is inspected.
+    void processExpiredMemberships() {
+        ensureExpiryQueue();
+        int64_t now = static_cast<int64_t>(time(nullptr));
+        if (!expiryQueue.hasDue(now)) return;
+
+        // Each lapsed member is found through the key index and only their chunk
+        // is copied, so the work follows the number of memberships due.
+        ResidentTable<Trainee>::Version trainees = resident(traineeRows, TRAINEE_FILE);
+        PersistentVector<Trainee> next = *trainees;
+        vector<int> lapsed;
+        vector<ChangeRecord> updates;
+        for (const auto& due : expiryQueue.popDue(now)) {
+            size_t i = traineeRows.positionOf(trainees, due.first);
+            if (i == PersistentVector<Trainee>::npos) continue;
+            Trainee t = next[i];
+            if (t.membership_expiry != due.second || t.payment_status != "Paid") continue; // stale entry
+            t.payment_status = "Due";
+            lapsed.push_back(t.id);
+            updates.push_back(change("trainee", "update", to_string(t.id), t.redactedString()));
+            next = next.replaced(i, move(t));
+        }
+        if (lapsed.empty()) return;
+
+        publish(traineeRows, move(next), TRAINEE_FILE, "trainees");
+        logChanges(updates);
+        revokeClassAccess(lapsed);
+    }
+
+    void renewMembership() {
+        Console::banner("RENEW MEMBERSHIP");
+        processExpiredMemberships();
+        int id = InputUtils::get_numeric_input<int>("Enter Trainee ID: ");
+        ResidentTable<Trainee>::Version trainees = resident(traineeRows, TRAINEE_FILE);
+        size_t i = traineeRows.positionOf(trainees, id);
+        if (i == PersistentVector<Trainee>::npos) {
+            cout << "Trainee not found!\n";
+            return;
+        }
+        Trainee t = (*trainees)[i];
+
+        Console::print("Current membership: {}, {}, expires {}\n", t.membership_package, t.payment_status,
+                       ScheduleUtils::formatDate(static_cast<time_t>(t.membership_expiry)));
+        cout << "1. 3 Months\n";
+        cout << "2. 6 Months\n";
+        int duration_choice = InputUtils::get_numeric_input<int>("Choose renewal duration (1-2): ", 1, 2);
+        int duration = (duration_choice == 2) ? 6 : 3;
+        Console::print("Renewal cost is ${}.\n", getCost(t.membership_package, duration));
+        if (!InputUtils::confirm_action("Confirm payment? (y/n): ")) {
+            cout << "Renewal cancelled.\n";
+            return;
+        }
+
+        // Apply the renewal to the record as it is now, not as it was before the prompts.
+        string quotedPackage = t.membership_package;
+        trainees = resident(traineeRows, TRAINEE_FILE);
+        i = traineeRows.positionOf(trainees, id);
+        if (i == PersistentVector<Trainee>::npos) {
+            cout << "Trainee was removed in the meantime. Renewal cancelled.\n";
+            return;
+        }
+        t = (*trainees)[i];
+        if (t.membership_package != quotedPackage) {
+            cout << "The membership package changed in the meantime. Renewal cancelled; please try again.\n";
+            return;
+        }
+
+        // Active memberships are extended from their current expiry; lapsed ones restart today.
+        time_t now = time(nullptr);
+        time_t start = t.isMembershipActive(now) ? static_cast<time_t>(t.membership_expiry) : now;
+        t.membership_duration_months = duration;
+        t.payment_status = "Paid";
+        int64_t originalStart = t.membership_start;
+        t.startMembership(start);
+        if (start != now) t.membership_start = originalStart;
+        publish(traineeRows, trainees->replaced(i, t), TRAINEE_FILE, "trainees");
+        logChange("trainee", "update", to_string(t.id), t.redactedString());
+        expiryQueue.schedule(t.id, t.membership_expiry);
+        Console::print("Membership renewed until {}.\n", ScheduleUtils::formatDate(static_cast<time_t>(t.membership_expiry)));
+    }
+
+    // --- Check-ins and Attendance ---
+    void recordCheckInEvent(CheckInKind kind, int traineeId, const string& className = "") {
+        checkIns.record(kind, traineeId, className);
+    }
+
+    void checkInTrainee(const Trainee& trainee) {
+        time_t now = time(nullptr);
+        checkIns.record(CheckInKind::Turnstile, trainee.id, "", now);
+        tm local_tm = ScheduleUtils::toLocalTm(now);
+        char stamp[8];
+        strftime(stamp, sizeof(stamp), "%H:%M", &local_tm);
+        Console::print("Welcome, {}! Checked in at {}.\n", trainee.name, string(stamp));
+    }
+
+    void recordCheckIn() {
+        Console::banner("RECORD CHECK-IN");
+        int id = InputUtils::get_numeric_input<int>("Enter Trainee ID: ");
+        vector<Trainee> trainees = loadTrainees();
+        if (!searchTraineeByID(id, trainees)) {
+            cout << "Trainee not found!\n";
+            return;
+        }
+
+        cout << "1. Turnstile entry\n";
+        cout << "2. Class attendance\n";
+        int kind = InputUtils::get_numeric_input<int>("Choose event type (1-2): ", 1, 2);
+        if (kind == 1) {
+            checkIns.record(CheckInKind::Turnstile, id);
+            cout << "Turnstile check-in recorded.\n";
+            return;
+        }
+
+        string className = InputUtils::get_non_empty_string("Enter Class Name: ");
+        for (const auto& c : loadClasses()) {
+            if (c.className == className) {
+                if (!c.isEnrolled(id)) {
+                    cout << "Trainee is not enrolled in this class.\n";
+                    return;
+                }
+                checkIns.record(CheckInKind::ClassAttendance, id, className);
+                cout << "Class attendance recorded.\n";
+                return;
+            }
+        }
+        cout << "Class not found!\n";
+    }
+
+    void displayAttendanceReport() {
+        Console::banner("ATTENDANCE REPORT");
+        cout << "1. Trainee visits\n";
+        cout << "2. Class attendance\n";
+        int choice = InputUtils::get_numeric_input<int>("Choose report (1-2): ", 1, 2);
+
+        checkIns.flush();
+        int64_t today = ScheduleUtils::localDayNumber(time(nullptr));
+        const int WINDOW_DAYS = 30;
+        int64_t windowStart = today - (WINDOW_DAYS - 1);
+
+        if (choice == 1) {
+            int id = InputUtils::get_numeric_input<int>("Enter Trainee ID: ");
+            int daysVisited = checkIns.traineeDaysVisited(id, windowStart, today);
+            Console::print("Check-ins (last 7 days): {}\n", checkIns.traineeVisits(id, today - 6, today));
+            Console::print("Check-ins (last {} days): {}\n", WINDOW_DAYS, checkIns.traineeVisits(id, windowStart, today));
+            Console::print("Visit rate (last {0} days): {1}/{0} days ({2}%)\n", WINDOW_DAYS, daysVisited, daysVisited * 100 / WINDOW_DAYS);
+            cout << "--- Last 7 days ---\n";
+            for (int64_t day = today - 6; day <= today; day++) {
+                Console::print("  {}: {}\n", ScheduleUtils::WEEK_DAYS[ScheduleUtils::weekDayIndex(day)], checkIns.traineeVisits(id, day, day));
+            }
+            return;
+        }
+
+        string className = InputUtils::get_non_empty_string("Enter Class Name: ");
+        for (const auto& c : loadClasses()) {
+            if (c.className != className) continue;
+
+            int classDay = ScheduleUtils::toMinuteOfWeek(c.schedule) / ScheduleUtils::MINUTES_PER_DAY;
+            int sessions = 0;
+            for (int64_t day = windowStart; day <= today; day++) {
+                if (ScheduleUtils::weekDayIndex(day) == classDay) sessions++;
+            }
+            int attended = checkIns.classAttendance(className, windowStart, today);
+            int expected = sessions * c.enrolledCount();
+            Console::print("Sessions held (last {} days): {}\n", WINDOW_DAYS, sessions);
+            Console::print("Attendance records: {}\n", attended);
+            if (expected > 0) {
+                Console::print("Attendance rate: {}% of enrolled seats\n", attended * 100 / expected);
+            } else {
+                cout << "Attendance rate: n/a (no enrolled trainees or sessions)\n";
+            }
+            return;
+        }
+        cout << "Class not found!\n";
+    }
+
+    // Reports print from one snapshot, so a save that lands mid-listing
+    // cannot tear the output.
+    void viewPaymentStatus() {
+        Console::banner("TRAINEE PAYMENT STATUS");
+        ResidentTable<Trainee>::Version trainees = snapshot().trainees;
+        if (trainees->empty()) {
+            cout << "No trainees registered.\n";
+            return;
+        }
+        
+        for (const auto& t : *trainees) {
+            Console::print("ID: {}, Name: {}, Package: {} ({} months), Status: {}, Expires: {}\n", t.id, t.name,
+                           t.membership_package, t.membership_duration_months, t.payment_status,
+                           ScheduleUtils::formatDate(static_cast<time_t>(t.membership_expiry)));
+        }
+    }
+
+    // --- Generic Utility Functions (Mostly unchanged, now called by robust functions) ---
+    // Membership fields are owned by the desk (renewals, expiry), so a trainee's
+    // possibly stale in-session copy only updates the profile fields. A newly
+    // entered plaintext password is hashed here and written back to the caller.
+    void updateTraineeInFile(Trainee& updatedTrainee) {
+        if (!PasswordUtils::isHashed(updatedTrainee.password)) {
+            updatedTrainee.password = PasswordUtils::hashPassword(updatedTrainee.password);
+            if (credentialsReady) credentials.put(Role::Trainee, to_string(updatedTrainee.id), updatedTrainee.password);
+        }
+        ResidentTable<Trainee>::Version trainees = resident(traineeRows, TRAINEE_FILE);
+        size_t i = traineeRows.positionOf(trainees, updatedTrainee.id);
+        if (i == PersistentVector<Trainee>::npos) return;
+        Trainee t = (*trainees)[i];
+        t.name = updatedTrainee.name;
+        t.contact = updatedTrainee.contact;
+        t.password = updatedTrainee.password;
+        t.height_m = updatedTrainee.height_m;
+        t.weight_kg = updatedTrainee.weight_kg;
+        publish(traineeRows, trainees->replaced(i, t), TRAINEE_FILE, "trainees");
+        logChange("trainee", "update", to_string(t.id), t.redactedString());
+    }
+    
+    // Single-record lookups; lazy mode decodes just this row (or hits the LRU cache).
+    bool findTrainee(int id, Trainee& out) {
+        if (!lazyLoadingEnabled()) resident(traineeRows, TRAINEE_FILE);
+        return lookup(traineeRows, traineeTable, id, out);
+    }
+
+    bool findTrainer(int id, Trainer& out) {
+        if (!lazyLoadingEnabled()) resident(trainerRows, TRAINER_FILE);
+        return lookup(trainerRows, trainerTable, id, out);
+    }
+
+    Trainee* searchTraineeByID(int id, vector<Trainee>& trainees) { 
+        for (auto& t : trainees) {
+            if (t.id == id) return &t;
+        }
+        return nullptr;
+    }
+    void displayTrainees() { 
+        Console::banner("TRAINEES LIST");
+        
+        ResidentTable<Trainee>::Version trainees = snapshot().trainees;
+        if (trainees->empty()) {
+            cout << "No trainees enrolled.\n";
+            return;
+        }
+        
+        for (const auto& t : *trainees) {
+            Console::print("ID: {}, Name: {}, Contact: {}, Membership: {}\n", t.id, t.name, t.contact, t.membership_package);
+        }
+    }
+        void provideBmiFeedback(float bmi) {
+        cout << "\n--- General Fitness Feedback ---\n";
+        if (bmi < 18.5) {
+            cout << "Category: Underweight\n";
+            cout << "Suggestion: Focus on strength training to build healthy muscle mass. Consider consulting a nutritionist to ensure you're getting enough calories and nutrients.\n";
+        } else if (bmi >= 18.5 && bmi < 25) {
+            cout << "Category: Normal Weight\n";
+            cout << "Suggestion: Great job! Maintain your health with a balanced routine of cardiovascular exercise (like running or cycling) and strength training.\n";
+        } else if (bmi >= 25 && bmi < 30) {
+            cout << "Category: Overweight\n";
+            cout << "Suggestion: A combination of consistent cardiovascular exercise and resistance training is recommended. Seeking professional dietary advice can also be very beneficial.\n";
+        } else { // bmi >= 30
+            cout << "Category: Obese\n";
+            cout << "Suggestion: It's recommended to combine consistent cardiovascular exercise with resistance training. Please consider seeking professional dietary advice for a personalized plan.\n";
+        }
+        cout << "\n** DISCLAIMER **\n";
+        cout << "These suggestions are for informational purposes only and do not constitute professional medical advice. Always consult with a healthcare provider before starting any new fitness or diet program.\n";
+    }
+    // Applies every staged operation with one validation pass and at most one
+    // write per affected file, and returns once that write has committed. On a
+    // validation or write failure nothing is changed.
+    TransactionResult commitTransaction(const AdminTransaction& txn) {
+        TransactionResult result;
+        ResidentTable<Trainee>::Version trainees = resident(traineeRows, TRAINEE_FILE);
+        ResidentTable<Trainer>::Version trainers = resident(trainerRows, TRAINER_FILE);
+        ResidentTable<GymClass>::Version classes = resident(classRows, CLASS_FILE);
+
+        // Validation pass: every target must exist and may only be deleted once.
+        unordered_set<int> traineesToDelete, trainersToDelete;
+        unordered_set<string> classesToDelete;
+        for (const auto& op : txn.ops) {
+            if (op.type == AdminTransaction::OpType::DeleteTrainee) {
+                if (traineeRows.positionOf(trainees, op.id) == PersistentVector<Trainee>::npos || !traineesToDelete.insert(op.id).second) {
+                    result.failure = TransactionResult::Failure::NotFound;
+                    result.error = "Trainee " + to_string(op.id) + " not found";
+                    return result;
+                }
+            } else if (op.type == AdminTransaction::OpType::DeleteTrainer) {
+                if (trainerRows.positionOf(trainers, op.id) == PersistentVector<Trainer>::npos || !trainersToDelete.insert(op.id).second) {
+                    result.failure = TransactionResult::Failure::NotFound;
+                    result.error = "Trainer " + to_string(op.id) + " not found";
+                    return result;
                 }
-            }
-            if (id_exists) {
-                cout << "Error: ID already exists. Please try a different ID.\n";
             } else {
-                break;
+                if (classRows.positionOf(classes, op.className) == PersistentVector<GymClass>::npos ||
+                    !classesToDelete.insert(op.className).second) {
+                    result.failure = TransactionResult::Failure::NotFound;
+                    result.error = "Class '" + op.className + "' not found";
+                    return result;
+                }
             }
         }
-        
-        string name = InputUtils::get_non_empty_string("Enter Name: ");
-        string contact = InputUtils::get_contact_number("Enter Contact (10 digits): ");
 
-        cout << "--- Membership Packages ---\n";
-        cout << "1. Basic (Access to gym floor)\n";
-        cout << "2. Premium (Access to gym floor + all classes)\n";
-        int package_choice = InputUtils::get_numeric_input<int>("Choose package (1-2): ", 1, 2);
-        string package = (package_choice == 2) ? "Premium" : "Basic";
+        // Apply pass, entirely in memory. Only the chunks holding deleted or
+        // changed rows are copied; the rest are shared with the current versions.
+        PersistentVector<Trainee> keptTrainees = trainees->erased([&](const Trainee& t) { return traineesToDelete.count(t.id) > 0; });
+        result.traineesRemoved = static_cast<int>(trainees->size() - keptTrainees.size());
 
-        cout << "--- Membership Duration ---\n";
-        cout << "1. 3 Months\n";
-        cout << "2. 6 Months\n";
-        int duration_choice = InputUtils::get_numeric_input<int>("Choose duration (1-2): ", 1, 2);
-        int package_duration = (duration_choice == 2) ? 6 : 3;
+        unordered_set<string> trainerNamesToDelete;
+        for (int id : trainersToDelete) trainerNamesToDelete.insert((*trainers)[trainerRows.positionOf(trainers, id)].name);
+        PersistentVector<Trainer> keptTrainers = trainers->erased([&](const Trainer& t) { return trainersToDelete.count(t.id) > 0; });
+        result.trainersRemoved = static_cast<int>(trainers->size() - keptTrainers.size());
 
-        int cost = getCost(package, package_duration);
-        cout << "Total cost for " << package << " membership for " << package_duration << " months is $" << cost << ".\n";
-        
-        if (!InputUtils::confirm_action("Confirm registration? (y/n): ")) {
-            cout << "Registration cancelled.\n";
-            return;
+        auto classRemoved = [&](const GymClass& c) {
+            return classesToDelete.count(c.className) > 0 || trainerNamesToDelete.count(c.trainerName) > 0;
+        };
+        vector<GymClass> removedClasses;
+        unordered_set<string> removedNames;
+        if (!classesToDelete.empty() || !trainerNamesToDelete.empty()) {
+            for (const auto& c : *classes) {
+                if (!classRemoved(c)) continue;
+                removedClasses.push_back(c);
+                removedNames.insert(c.className);
+            }
         }
+        result.classesRemoved = static_cast<int>(removedClasses.size());
 
-        string password = InputUtils::get_hidden_password("Create Password: ");
+        vector<ChangeRecord> feed;
+        for (int id : traineesToDelete) feed.push_back(change("trainee", "delete", to_string(id)));
+        for (int id : trainersToDelete) feed.push_back(change("trainer", "delete", to_string(id)));
+        for (const auto& c : removedClasses) feed.push_back(change("class", "delete", c.className));
 
-        trainees.push_back(Trainee(id, name, contact, password, package, package_duration));
-        saveTrainees(trainees);
-        cout << "Trainee registered and payment confirmed successfully!\n";
+        // Deleted trainees and classes leave the waitlists before any promotion looks at them.
+        ensureWaitlists();
+        ClassWaitlists waitlistsBefore = waitlists;
+        bool waitlistChanged = false;
+        for (int id : traineesToDelete) {
+            if (!waitlists.removeEverywhere(id).empty()) waitlistChanged = true;
+        }
+        for (const auto& c : removedClasses) {
+            if (waitlists.dropClass(c.className)) waitlistChanged = true;
+        }
+
+        // Rosters of the deleted trainees' remaining classes, found through the
+        // enrollment index and visited in file order.
+        ensureEnrollmentIndex();
+        set<size_t> rosterPositions;
+        for (int id : traineesToDelete) {
+            for (const auto& name : enrollmentIndex.classesOf(id)) {
+                if (removedNames.count(name)) continue;
+                size_t i = classRows.positionOf(classes, name);
+                if (i != PersistentVector<GymClass>::npos) rosterPositions.insert(i);
+            }
+        }
+        PersistentVector<GymClass> nextClasses = *classes;
+        vector<GymClass> touchedClasses;
+        for (size_t i : rosterPositions) {
+            GymClass c = (*classes)[i];
+            bool classChanged = false;
+            for (int id : traineesToDelete) {
+                if (c.enrolledTrainees.remove(id)) {
+                    classChanged = true;
+                    feed.push_back(change("enrollment", "delete", enrollmentKey(c, id)));
+                }
+            }
+            if (!classChanged) continue;
+            if (promoteWaitlisted(c, feed)) waitlistChanged = true;
+            nextClasses = nextClasses.replaced(i, c);
+            touchedClasses.push_back(move(c));
+        }
+        if (!removedClasses.empty()) nextClasses = nextClasses.erased(classRemoved);
+        bool classesChanged = !removedClasses.empty() || !touchedClasses.empty();
+
+        // Single commit across every affected file, written as one set by the
+        // flusher. The new versions go live only while it is being written.
+        vector<pair<string, AsyncFlusher::Serializer>> files;
+        if (result.traineesRemoved > 0) {
+            traineeRows.publish(move(keptTrainees));
+            files.push_back(pendingWrite(TRAINEE_FILE, traineeRows.snapshot(), "trainees"));
+        }
+        if (result.trainersRemoved > 0) {
+            trainerRows.publish(move(keptTrainers));
+            files.push_back(pendingWrite(TRAINER_FILE, trainerRows.snapshot(), "trainers"));
+        }
+        if (classesChanged) {
+            classRows.publish(move(nextClasses));
+            files.push_back(pendingWrite(CLASS_FILE, classRows.snapshot(), "classes"));
+        }
+        if (waitlistChanged) files.push_back(pendingWaitlistWrite());
+        string writeError;
+        if (!persistence.submitAndWait(move(files), writeError)) {
+            if (result.traineesRemoved > 0) traineeRows.publish(*trainees);
+            if (result.trainersRemoved > 0) trainerRows.publish(*trainers);
+            if (classesChanged) classRows.publish(*classes);
+            waitlists = move(waitlistsBefore);
+            result = TransactionResult();
+            result.failure = TransactionResult::Failure::WriteFailed;
+            result.error = writeError;
+            return result;
+        }
+        logChanges(feed);
+
+        for (const auto& c : removedClasses) onClassRemoved(c);
+        for (const auto& c : touchedClasses) onEnrollmentChanged(c);
+        if (credentialsReady) {
+            for (int id : traineesToDelete) credentials.erase(Role::Trainee, to_string(id));
+            for (int id : trainersToDelete) credentials.erase(Role::Trainer, to_string(id));
+        }
+        result.committed = true;
+        return result;
     }
 
-    void addTrainer() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                               ADD TRAINER                                   *\n";
-        cout << "********************************************************************************\n";
-        
-        vector<Trainer> trainers = loadTrainers();
-        int id;
+    void deleteTrainee(int id) { 
+        AdminTransaction txn;
+        txn.deleteTrainee(id);
+        TransactionResult result = commitTransaction(txn);
+        if (result.committed) {
+            cout << "Trainee deleted successfully!\n";
+        } else if (result.failure == TransactionResult::Failure::NotFound) {
+            cout << "Trainee not found!\n";
+        } else {
+            Console::print("Error: {}. The trainee was not deleted.\n", result.error);
+        }
+    }
+    void deleteTrainer(int id) { 
+        AdminTransaction txn;
+        txn.deleteTrainer(id);
+        TransactionResult result = commitTransaction(txn);
+        if (!result.committed) {
+            if (result.failure == TransactionResult::Failure::NotFound) cout << "Trainer not found!\n";
+            else Console::print("Error: {}. The trainer was not deleted.\n", result.error);
+        } else if (result.classesRemoved > 0) {
+            cout << "Trainer and associated classes deleted successfully!\n";
+        } else {
+            cout << "Trainer deleted successfully! (No associated classes found)\n";
+        }
+    }
+
+    void bulkRosterCleanup() {
+        Console::banner("BULK ROSTER CLEANUP");
+        AdminTransaction txn;
         while (true) {
-            id = InputUtils::get_numeric_input<int>("Enter Trainer ID: ");
-            bool id_exists = false;
-            for (const auto& t : trainers) {
-                if (t.id == id) {
-                    id_exists = true;
-                    break;
+            Console::print("\nStaged operations: {}\n", txn.size());
+            cout << "1. Stage trainee deletions   4. Commit\n";
+            cout << "2. Stage trainer deletions   5. Cancel\n";
+            cout << "3. Stage class deletion\n";
+            int choice = InputUtils::get_numeric_input<int>("Enter choice (1-5): ", 1, 5);
+
+            if (choice == 1 || choice == 2) {
+                string list = InputUtils::get_non_empty_string("Enter IDs (separated by spaces or commas): ");
+                replace(list.begin(), list.end(), ',', ' ');
+                stringstream ss(list);
+                string token;
+                int staged = 0;
+                while (ss >> token) {
+                    try {
+                        int id = stoi(token);
+                        if (choice == 1) txn.deleteTrainee(id);
+                        else txn.deleteTrainer(id);
+                        staged++;
+                    } catch (const exception&) {
+                        Console::print("Skipping invalid ID '{}'.\n", token);
+                    }
                 }
-            }
-            if (id_exists) {
-                 cout << "Error: ID already exists. Operation aborted.\n";
+                Console::print("{} deletion(s) staged.\n", staged);
+            } else if (choice == 3) {
+                txn.deleteClass(InputUtils::get_non_empty_string("Enter Class Name to delete: "));
+            } else if (choice == 4) {
+                if (txn.empty()) {
+                    cout << "Nothing to commit.\n";
+                    return;
+                }
+                TransactionResult result = commitTransaction(txn);
+                if (!result.committed) {
+                    if (result.failure == TransactionResult::Failure::WriteFailed) {
+                        Console::print("Transaction rolled back: the save failed ({}). No changes were made.\n", result.error);
+                    } else {
+                        Console::print("Transaction rolled back: {}. No changes were made.\n", result.error);
+                    }
+                    return;
+                }
+                Console::print("Committed: {} trainee(s), {} trainer(s) and {} class(es) removed.\n", result.traineesRemoved,
+                               result.trainersRemoved, result.classesRemoved);
+                return;
             } else {
-                break;
+                cout << "Transaction cancelled. No changes were made.\n";
+                return;
+            }
+        }
+    }
+    void searchTrainerByID(int id) { 
+        vector<Trainer> trainers = loadTrainers();
+        for (const auto& t : trainers) {
+            if (t.id == id) {
+                Console::banner("TRAINER DETAILS");
+                Console::print("ID: {}\nName: {}\nSpecialization: {}\nContact: {}\n", t.id, t.name, t.specialization, t.contact);
+                return;
             }
         }
+        cout << "Trainer not found!\n";
+    }
+    void deleteClass(const string& className) { 
+        AdminTransaction txn;
+        txn.deleteClass(className);
+        TransactionResult result = commitTransaction(txn);
+        if (result.committed) {
+            Console::print("Class '{}' deleted successfully!\n", className);
+        } else if (result.failure == TransactionResult::Failure::NotFound) {
+            cout << "Class not found!\n";
+        } else {
+            Console::print("Error: {}. The class was not deleted.\n", result.error);
+        }
+    }
+    void displayTrainers() { 
+        Console::banner("TRAINERS LIST");
         
-        string name = InputUtils::get_non_empty_string("Enter Name: ");
-        string specialization = InputUtils::get_non_empty_string("Enter Specialization: ");
-        string contact = InputUtils::get_contact_number("Enter Contact (10 digits): ");
-        string password = InputUtils::get_hidden_password("Enter Password: ");
-
-        trainers.push_back(Trainer(id, name, specialization, contact, password));
-        saveTrainers(trainers);
-        cout << "Trainer added successfully!\n";
+        ResidentTable<Trainer>::Version trainers = snapshot().trainers;
+        if (trainers->empty()) {
+            cout << "No trainers registered.\n";
+            return;
+        }
+        
+        for (const auto& t : *trainers) {
+            Console::print("ID: {}, Name: {}, Specialization: {}, Contact: {}\n", t.id, t.name, t.specialization, t.contact);
+        }
     }
-    
-    // --- Login Functions (ENHANCED) ---
-    bool adminLogin() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                                ADMIN LOGIN                                 *\n";
-        cout << "********************************************************************************\n";
-        string username = InputUtils::get_non_empty_string("Username: ");
-        string password = InputUtils::get_hidden_password("Password: ");
+    void updateTrainerInFile(Trainer& updatedTrainer) { 
+        if (!PasswordUtils::isHashed(updatedTrainer.password)) {
+            updatedTrainer.password = PasswordUtils::hashPassword(updatedTrainer.password);
+            if (credentialsReady) credentials.put(Role::Trainer, to_string(updatedTrainer.id), updatedTrainer.password);
+        }
+        ResidentTable<Trainer>::Version trainers = resident(trainerRows, TRAINER_FILE);
+        size_t i = trainerRows.positionOf(trainers, updatedTrainer.id);
+        if (i == PersistentVector<Trainer>::npos) return;
+        publish(trainerRows, trainers->replaced(i, updatedTrainer), TRAINER_FILE, "trainers");
+        logChange("trainer", "update", to_string(updatedTrainer.id), updatedTrainer.redactedString());
+    }
+    void displayClassesForTrainer(const Trainer& trainer) { 
+        Console::banner("CLASSES TAUGHT BY " + trainer.name);
         
-        ifstream file(ADMIN_FILE);
+        vector<GymClass> classes = loadClasses();
+        bool foundAny = false;
+        
+        for (const auto& c : classes) {
+            if (c.trainerName == trainer.name) {
+                Console::print("Class: {}, Schedule: {}, Duration: {} min, Capacity: {}, Enrolled: {}\n", c.className, c.schedule,
+                               c.duration_minutes, c.capacity, c.enrolledCount());
+                foundAny = true;
+            }
+        }
+        
+        if (!foundAny) cout << "No classes assigned.\n";
+    }
+    void displayTraineesForTrainer(const Trainer& trainer) { 
+        Console::banner("TRAINEES IN CLASSES TAUGHT BY " + trainer.name);
+        
+        // Rosters and names come from the same cut of both tables.
+        TableSnapshot view = snapshot();
+        unordered_map<int, const Trainee*> byId;
+        for (const auto& t : *view.trainees) byId[t.id] = &t;
+        bool foundAny = false;
+        
+        for (const auto& c : *view.classes) {
+            if (c.trainerName == trainer.name) {
+                Console::print("Class: {}\n", c.className);
+                if (c.enrolledTrainees.empty()) {
+                    cout << "  No trainees enrolled.\n";
+                } else {
+                    for (auto tid : c.enrolledTrainees.toVector()) {
+                        auto it = byId.find(tid);
+                        if (it != byId.end()) Console::print("  ID: {}, Name: {}\n", it->second->id, it->second->name);
+                    }
+                }
+                foundAny = true;
+            }
+        }
+        
+        if (!foundAny) cout << "No classes assigned, thus no trainees.\n";
+    }
+};
+
+// =================================================================================
+// ||                              BRANCH SHARDS                                  ||
+// =================================================================================
+// One branch's data. `lock` must be held by any thread other than the menu
+// thread that touches `gym`, so different branches proceed in parallel while
+// each branch sees one writer at a time.
+struct BranchShard {
+    string name;
+    string dataDir;
+    unique_ptr<GymManagement> gym;
+    mutex lock;
+};
+
+struct MemberMatch {
+    string branch;
+    Trainee trainee;
+};
+
+struct BranchPaymentSummary {
+    string branch;
+    int members = 0;
+    int paid = 0;
+    int due = 0;
+    long long revenue = 0;
+    vector<Trainee> dueMembers;
+};
+
+// Owns one shard per branch. The main branch keeps using the top-level data
+// files so existing single-gym installs keep working; other branches live in
+// branches/<name>/ and are listed in branches.txt.
+class BranchRegistry {
+private:
+    static inline const string BRANCH_FILE = "branches.txt";
+    static inline const string BRANCH_ROOT = "branches/";
+
+    vector<unique_ptr<BranchShard>> shards; // shards[0] is the main branch
+    ThreadPool pool;
+
+    BranchShard& open(const string& name) {
+        auto shard = unique_ptr<BranchShard>(new BranchShard());
+        shard->name = name;
+        shard->dataDir = dataDirOf(name);
+        if (!shard->dataDir.empty()) {
+            error_code ec;
+            filesystem::create_directories(shard->dataDir, ec);
+        }
+        shard->gym = unique_ptr<GymManagement>(new GymManagement(shard->dataDir));
+        shards.push_back(move(shard));
+        return *shards.back();
+    }
+
+    // Runs `perView` on every branch in parallel and returns the results in
+    // branch order. The shard lock is held only while the snapshot is taken,
+    // so a branch keeps accepting writes while its report is computed.
+    template <typename R, typename F>
+    vector<R> fanOut(F perView) {
+        vector<future<R>> pending;
+        for (auto& shard : shards) {
+            BranchShard* target = shard.get();
+            pending.push_back(pool.submit([target, perView]() {
+                TableSnapshot view;
+                {
+                    lock_guard<mutex> guard(target->lock);
+                    view = target->gym->snapshot();
+                }
+                return perView(*target, view);
+            }));
+        }
+        vector<R> results;
+        for (auto& f : pending) results.push_back(f.get());
+        return results;
+    }
+
+public:
+    static constexpr const char* DEFAULT_BRANCH = "main";
+
+    BranchRegistry() {
+        for (const auto& name : listBranches()) open(name);
+    }
+
+    // The main branch followed by every branch in branches.txt, read without
+    // opening (and so without recovering or rewriting) any branch's data.
+    static vector<string> listBranches() {
+        vector<string> names = {DEFAULT_BRANCH};
+        ifstream file(BRANCH_FILE);
         string line;
         while (getline(file, line)) {
-            stringstream ss(line);
-            string storedUsername, storedPassword;
-            getline(ss, storedUsername, ',');
-            getline(ss, storedPassword, ',');
-            
-            if (storedUsername == username && storedPassword == password) {
-                cout << "Admin login successful!\n";
-                file.close();
-                return true;
+            if (!line.empty() && ::find(names.begin(), names.end(), line) == names.end()) names.push_back(line);
+        }
+        return names;
+    }
+
+    static string dataDirOf(const string& name) {
+        return name == DEFAULT_BRANCH ? "" : BRANCH_ROOT + name + "/";
+    }
+
+    static bool isValidBranchName(const string& name) {
+        if (name.empty() || name.size() > 32) return false;
+        return all_of(name.begin(), name.end(), [](char ch) {
+            return isalnum(static_cast<unsigned char>(ch)) || ch == '-' || ch == '_';
+        });
+    }
+
+    vector<string> branchNames() const {
+        vector<string> names;
+        for (const auto& shard : shards) names.push_back(shard->name);
+        return names;
+    }
+
+    size_t branchCount() const { return shards.size(); }
+
+    BranchShard* find(const string& name) {
+        for (auto& shard : shards) {
+            if (shard->name == name) return shard.get();
+        }
+        return nullptr;
+    }
+
+    bool addBranch(const string& name, string& error) {
+        if (!isValidBranchName(name)) {
+            error = "Branch names may only contain letters, digits, '-' and '_'";
+            return false;
+        }
+        if (find(name)) {
+            error = "Branch already exists";
+            return false;
+        }
+        ofstream file(BRANCH_FILE, ios::app);
+        if (!file) {
+            error = "Could not update " + BRANCH_FILE;
+            return false;
+        }
+        file << name << "\n";
+        open(name);
+        return true;
+    }
+
+    // Case-insensitive name search across every branch.
+    vector<MemberMatch> searchMembers(const string& fragment) {
+        string needle = fragment;
+        transform(needle.begin(), needle.end(), needle.begin(), ::tolower);
+        auto perBranch = fanOut<vector<MemberMatch>>([needle](const BranchShard& shard, const TableSnapshot& view) {
+            vector<MemberMatch> matches;
+            for (const auto& t : *view.trainees) {
+                string name = t.name;
+                transform(name.begin(), name.end(), name.begin(), ::tolower);
+                if (name.find(needle) != string::npos) matches.push_back(MemberMatch{shard.name, t});
+            }
+            return matches;
+        });
+        vector<MemberMatch> merged;
+        for (auto& matches : perBranch) merged.insert(merged.end(), matches.begin(), matches.end());
+        return merged;
+    }
+
+    vector<BranchPaymentSummary> paymentSummaries() {
+        return fanOut<BranchPaymentSummary>([](const BranchShard& shard, const TableSnapshot& view) {
+            BranchPaymentSummary summary;
+            summary.branch = shard.name;
+            for (const auto& t : *view.trainees) {
+                summary.members++;
+                if (t.payment_status == "Paid") {
+                    summary.paid++;
+                    summary.revenue += GymManagement::getMembershipCost(t);
+                } else {
+                    summary.due++;
+                    summary.dueMembers.push_back(t);
+                }
             }
+            return summary;
+        });
+    }
+
+    long long totalRevenue() {
+        long long total = 0;
+        for (const auto& summary : paymentSummaries()) total += summary.revenue;
+        return total;
+    }
+
+    // Waits for every branch's queued saves; false if any background write failed.
+    bool flushAll() {
+        bool ok = true;
+        for (auto& shard : shards) {
+            lock_guard<mutex> guard(shard->lock);
+            if (!shard->gym->flushPersistence()) ok = false;
         }
-        file.close();
-        cout << "Invalid credentials!\n";
-        return false;
+        return ok;
     }
 
-    bool trainerLogin(Trainer& loggedInTrainer) {
-        cout << "\n********************************************************************************\n";
-        cout << "*                               TRAINER LOGIN                               *\n";
-        cout << "********************************************************************************\n";
-        int id = InputUtils::get_numeric_input<int>("Trainer ID: ");
-        string password = InputUtils::get_hidden_password("Password: ");
-        
-        vector<Trainer> trainers = loadTrainers();
-        for (const auto& t : trainers) {
-            if (t.id == id && t.password == password) {
-                cout << "Trainer login successful!\n";
-                loggedInTrainer = t;
-                return true;
+    size_t workerCount() const { return pool.size(); }
+};
+// =================================================================================
+
+// =================================================================================
+// ||                     WORKLOAD GENERATOR & REPLAY TOOL                        ||
+// =================================================================================
+// Offline load testing. `--generate-workload` writes a reproducible operation
+// trace (seeded, Zipfian class popularity, diurnal arrival rate) and `--replay`
+// drives GymManagement with it from several threads against scratch branch data,
+// then reports throughput and tail latency per operation type. By default the
+// replay ignores the trace's timestamps and runs flat out (a throughput test);
+// `--speedup N` releases each op at offsetMs / N instead, so the diurnal peaks
+// arrive as bursts and latency includes the time an op waited for a thread.
+namespace WorkloadTool {
+    const string FORMAT_HEADER = "# gms-workload v1";
+    const vector<string> OP_TYPES = {"checkin", "login", "signup", "view_schedule", "bulk_delete", "withdraw", "report"};
+
+    struct Params {
+        uint64_t seed = 42;
+        int ops = 5000;
+        int branches = 2;
+        int trainees = 200;     // per branch
+        int trainers = 10;      // per branch
+        int classes = 30;       // per branch
+        double zipfExponent = 1.1;
+        int days = 1;           // the trace is spread over this many simulated days
+        int hashIterations = 1000; // seeded accounts only; keeps setup fast
+    };
+
+    struct Op {
+        int64_t offsetMs = 0;
+        int branch = 0;
+        string type;
+        vector<string> args;
+    };
+
+    // Spelled out instead of uniform_real_distribution, whose output is
+    // implementation-defined, so a seed gives the same trace on every compiler.
+    class Random {
+    private:
+        mt19937_64 engine;
+
+    public:
+        explicit Random(uint64_t seed) : engine(seed) {}
+        double uniform() { return static_cast<double>(engine() >> 11) * (1.0 / 9007199254740992.0); }
+        int below(int n) { return static_cast<int>(uniform() * n); }
+        bool chance(double p) { return uniform() < p; }
+    };
+
+    // Class k (0-based) is picked with weight 1 / (k + 1)^s.
+    class ZipfSampler {
+    private:
+        vector<double> cdf;
+
+    public:
+        ZipfSampler(int n, double s) {
+            double sum = 0;
+            for (int k = 1; k <= n; k++) {
+                sum += 1.0 / pow(k, s);
+                cdf.push_back(sum);
+            }
+            for (auto& v : cdf) v /= sum;
+        }
+        int sample(Random& rng) const {
+            auto it = lower_bound(cdf.begin(), cdf.end(), rng.uniform());
+            return it == cdf.end() ? static_cast<int>(cdf.size()) - 1 : static_cast<int>(it - cdf.begin());
+        }
+    };
+
+    // Arrivals per minute over the day, relative to the peak: a quiet night,
+    // a morning rush around 07:00 and a larger evening rush around 18:00.
+    double diurnalFactor(double hourOfDay) {
+        auto bump = [](double h, double centre, double width) {
+            double d = (h - centre) / width;
+            return exp(-0.5 * d * d);
+        };
+        double f = 0.05 + 0.8 * bump(hourOfDay, 7.0, 1.0) + 1.0 * bump(hourOfDay, 18.0, 1.5)
+                 + 0.25 * bump(hourOfDay, 12.5, 1.0);
+        return min(f, 1.0);
+    }
+
+    // Relative weights of OP_TYPES for a given hour.
+    vector<double> opMix(int hour) {
+        if (hour >= 5 && hour < 10) return {50, 25, 10, 15, 0, 2, 1};   // morning check-ins
+        if (hour >= 16 && hour < 21) return {30, 30, 25, 15, 0, 6, 3};  // login rush, sign-up bursts, desk reports
+        if (hour >= 10 && hour < 16) return {15, 20, 25, 38, 2, 8, 3};  // admin work happens mid-day
+        return {10, 20, 20, 50, 0, 4, 1};
+    }
+
+    string classNameFor(int index) { return "Class" + to_string(index + 1); }
+    string passwordFor(int traineeId) { return "pw" + to_string(traineeId); }
+
+    vector<Op> generate(const Params& p) {
+        Random rng(p.seed);
+        ZipfSampler classPopularity(p.classes, p.zipfExponent);
+
+        // Scale the peak rate so that, on average, p.ops arrivals fill p.days.
+        double meanFactor = 0;
+        for (int m = 0; m < 24 * 60; m++) meanFactor += diurnalFactor(m / 60.0);
+        meanFactor /= 24 * 60;
+        double peakRatePerMinute = p.ops / (p.days * 24.0 * 60.0 * meanFactor);
+        vector<Op> ops;
+        ops.reserve(p.ops);
+        vector<vector<pair<string, string>>> signups(p.branches); // earlier (trainee, class) pairs, for withdrawals
+
+        // Non-homogeneous Poisson process by thinning: draw candidates at the
+        // peak rate and keep each with probability diurnalFactor(t).
+        double minute = 0;
+        while (static_cast<int>(ops.size()) < p.ops) {
+            minute += -log(1.0 - rng.uniform()) / peakRatePerMinute;
+            double hour = fmod(minute / 60.0, 24.0);
+            if (!rng.chance(diurnalFactor(hour))) continue;
+
+            Op op;
+            op.offsetMs = static_cast<int64_t>(minute * 60000.0);
+            op.branch = rng.below(p.branches);
+
+            vector<double> mix = opMix(static_cast<int>(hour));
+            double total = 0;
+            for (double w : mix) total += w;
+            double pick = rng.uniform() * total;
+            size_t type = 0;
+            while (type + 1 < mix.size() && pick >= mix[type]) pick -= mix[type++];
+            op.type = OP_TYPES[type];
+
+            int trainee = 1 + rng.below(p.trainees);
+            if (op.type == "checkin") {
+                op.args = {to_string(trainee)};
+            } else if (op.type == "login") {
+                op.args = {to_string(trainee), rng.chance(0.05) ? "wrong-password" : passwordFor(trainee)};
+            } else if (op.type == "signup") {
+                op.args = {to_string(trainee), classNameFor(classPopularity.sample(rng))};
+                signups[op.branch].emplace_back(op.args[0], op.args[1]);
+            } else if (op.type == "withdraw") {
+                vector<pair<string, string>>& earlier = signups[op.branch];
+                if (earlier.empty()) {
+                    op.args = {to_string(trainee), classNameFor(classPopularity.sample(rng))};
+                } else {
+                    size_t pick = static_cast<size_t>(rng.below(static_cast<int>(earlier.size())));
+                    op.args = {earlier[pick].first, earlier[pick].second};
+                    earlier[pick] = earlier.back();
+                    earlier.pop_back();
+                }
+            } else if (op.type == "view_schedule") {
+                op.args = {to_string(rng.below(8) - 1)}; // -1 = weekly view, 0..6 = one day
+            } else if (op.type == "bulk_delete") {
+                int count = 2 + rng.below(4);
+                for (int i = 0; i < count; i++) op.args.push_back(to_string(1 + rng.below(p.trainees)));
+            }
+            ops.push_back(op);
+        }
+        return ops;
+    }
+
+    bool writeWorkload(const string& path, const Params& p, const vector<Op>& ops) {
+        ofstream file(path);
+        if (!file) return false;
+        file << FORMAT_HEADER << " seed=" << p.seed << " branches=" << p.branches << " trainees=" << p.trainees
+             << " trainers=" << p.trainers << " classes=" << p.classes << "\n";
+        file << "# <offset_ms> <branch> <op> <args...>\n";
+        for (const auto& op : ops) {
+            file << op.offsetMs << " " << op.branch << " " << op.type;
+            for (const auto& a : op.args) file << " " << a;
+            file << "\n";
+        }
+        return static_cast<bool>(file);
+    }
+
+    bool readWorkload(const string& path, Params& p, vector<Op>& ops, string& error) {
+        ifstream file(path);
+        if (!file) {
+            error = "Could not open " + path;
+            return false;
+        }
+        string line;
+        if (!getline(file, line) || line.compare(0, FORMAT_HEADER.size(), FORMAT_HEADER) != 0) {
+            error = path + " is not a workload file";
+            return false;
+        }
+        stringstream header(line.substr(FORMAT_HEADER.size()));
+        string field;
+        while (header >> field) {
+            size_t eq = field.find('=');
+            if (eq == string::npos) continue;
+            string key = field.substr(0, eq);
+            long long value = atoll(field.c_str() + eq + 1);
+            if (key == "seed") p.seed = static_cast<uint64_t>(value);
+            else if (key == "branches") p.branches = static_cast<int>(value);
+            else if (key == "trainees") p.trainees = static_cast<int>(value);
+            else if (key == "trainers") p.trainers = static_cast<int>(value);
+            else if (key == "classes") p.classes = static_cast<int>(value);
+        }
+        if (p.branches < 1 || p.trainees < 1 || p.trainers < 1 || p.classes < 1) {
+            error = "Workload header has an empty data set";
+            return false;
+        }
+        int lineNo = 1;
+        while (getline(file, line)) {
+            lineNo++;
+            if (line.empty() || line[0] == '#') continue;
+            stringstream ss(line);
+            Op op;
+            if (!(ss >> op.offsetMs >> op.branch >> op.type) || op.branch < 0 || op.branch >= p.branches ||
+                find(OP_TYPES.begin(), OP_TYPES.end(), op.type) == OP_TYPES.end()) {
+                error = "Malformed operation on line " + to_string(lineNo);
+                return false;
             }
+            string arg;
+            while (ss >> arg) op.args.push_back(arg);
+            ops.push_back(op);
         }
-        cout << "Invalid credentials!\n";
-        return false;
+        return true;
     }
 
-    bool traineeLogin(Trainee& loggedInTrainee) {
-        cout << "\n********************************************************************************\n";
-        cout << "*                              TRAINEE LOGIN                                *\n";
-        cout << "********************************************************************************\n";
-        int id = InputUtils::get_numeric_input<int>("Trainee ID: ");
-        string password = InputUtils::get_hidden_password("Password: ");
-        
-        vector<Trainee> trainees = loadTrainees();
-        for (const auto& t : trainees) {
-            if (t.id == id && t.password == password) {
-                cout << "Login successful!\n";
-                loggedInTrainee = t;
-                return true;
-            }
+    // Writes a fresh data set for one branch directly to its files.
+    void seedBranch(GymManagement& gym, const Params& p) {
+        vector<Trainer> trainers;
+        for (int i = 1; i <= p.trainers; i++) {
+            trainers.emplace_back(i, "Trainer" + to_string(i), "General", "0000000000",
+                                  PasswordUtils::hashPassword("pw" + to_string(i), p.hashIterations));
         }
-        cout << "Invalid credentials!\n";
-        return false;
+        vector<Trainee> trainees;
+        for (int i = 1; i <= p.trainees; i++) {
+            trainees.emplace_back(i, "Member" + to_string(i), "0000000000",
+                                  PasswordUtils::hashPassword(passwordFor(i), p.hashIterations),
+                                  (i % 5 < 3) ? "Premium" : "Basic", 6);
+        }
+        vector<GymClass> classes;
+        for (int i = 0; i < p.classes; i++) {
+            string schedule = ScheduleUtils::WEEK_DAYS[i % 7] + "-" + (6 + (i / 7) % 14 < 10 ? "0" : "") +
+                              to_string(6 + (i / 7) % 14) + ":00";
+            classes.emplace_back(classNameFor(i), schedule, trainers[i % trainers.size()].name, 20);
+        }
+        gym.saveTrainers(trainers);
+        gym.saveTrainees(trainees);
+        gym.saveClasses(classes);
     }
 
-    // --- Class and Schedule Management (ENHANCED) ---
-    void addClass() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                               ADD CLASS                                    *\n";
-        cout << "********************************************************************************\n";
-        string className = InputUtils::get_non_empty_string("Enter Class Name (e.g., 'Leg Day', 'Yoga', 'HIIT'): ");
-        string schedule = InputUtils::get_valid_schedule("Enter Schedule (Format: Day-HH:MM, e.g., 'Mon-10:00'): ");
-        string trainerName = InputUtils::get_non_empty_string("Enter Trainer Name (must exist): ");
-        int capacity = InputUtils::get_numeric_input<int>("Enter Capacity: ", 1, 100);
+    struct OpStats {
+        vector<double> latenciesUs;
+        int failures = 0;
+    };
 
-        vector<Trainer> trainers = loadTrainers();
-        bool found = false;
-        for (const auto& t : trainers) {
-            if (t.name == trainerName) {
-                found = true;
-                break;
+    // Runs one operation under the caller's shard lock; returns false when the
+    // system rejected it (unknown member, full class, wrong password, ...).
+    bool execute(GymManagement& gym, const Op& op) {
+        if (op.type == "view_schedule") {
+            int day = op.args.empty() ? -1 : atoi(op.args[0].c_str());
+            const string& screen = (day < 0 || day > 6) ? gym.weeklyScheduleScreen() : gym.dailyScheduleScreen(day);
+            return !screen.empty();
+        }
+        if (op.args.empty()) return false;
+        int id = atoi(op.args[0].c_str());
+
+        if (op.type == "login") {
+            return op.args.size() > 1 && gym.verifyCredentials(Role::Trainee, to_string(id), op.args[1]);
+        }
+        if (op.type == "bulk_delete") {
+            AdminTransaction txn;
+            unordered_set<int> staged;
+            for (const auto& a : op.args) {
+                if (staged.insert(atoi(a.c_str())).second) txn.deleteTrainee(atoi(a.c_str()));
             }
+            return gym.commitTransaction(txn).committed;
         }
-        
-        if (!found) {
-            cout << "Trainer name not found! Class not added.\n";
-            return;
+
+        Trainee trainee;
+        if (!gym.findTrainee(id, trainee)) return false;
+        if (op.type == "checkin") {
+            gym.recordCheckInEvent(CheckInKind::Turnstile, id);
+            return true;
         }
-        
-        vector<GymClass> classes = loadClasses();
-        classes.push_back(GymClass(className, schedule, trainerName, capacity));
-        saveClasses(classes);
-        cout << "Class added successfully!\n";
+        if (op.args.size() < 2) return false;
+        if (op.type == "withdraw") {
+            GymManagement::WithdrawResult result = gym.withdrawTrainee(id, op.args[1]);
+            return result == GymManagement::WithdrawResult::Withdrawn || result == GymManagement::WithdrawResult::LeftWaitlist;
+        }
+        GymManagement::SignUpResult result = gym.enrollTrainee(trainee, op.args[1]);
+        return result == GymManagement::SignUpResult::Enrolled || result == GymManagement::SignUpResult::Waitlisted;
     }
 
-    void displayWeeklySchedule() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                             WEEKLY CLASS SCHEDULE                            *\n";
-        cout << "********************************************************************************\n";
-        vector<GymClass> classes = loadClasses();
-        if (classes.empty()) {
-            cout << "No classes have been scheduled for the week.\n";
-            return;
+    struct ReportTotals {
+        long long revenue = 0;
+        size_t due = 0;
+        size_t seats = 0;
+    };
+
+    ReportTotals summarize(const TableSnapshot& view) {
+        ReportTotals totals;
+        for (const auto& t : *view.trainees) {
+            if (t.payment_status == "Paid") totals.revenue += GymManagement::getMembershipCost(t);
+            else totals.due++;
         }
+        for (const auto& c : *view.classes) totals.seats += c.enrolledCount();
+        return totals;
+    }
 
-        sort(classes.begin(), classes.end(), [](const GymClass& a, const GymClass& b) {
-            return a.schedule < b.schedule;
-        });
+    // A desk report running next to the write traffic. Only taking the snapshot
+    // holds the shard lock; the scan does not. Returns false if the view is torn
+    // across tables: a class over capacity, or a roster naming someone missing
+    // from the same snapshot (trainees read after a deletion, classes before).
+    bool runReport(BranchShard& shard) {
+        TableSnapshot view;
+        {
+            lock_guard<mutex> guard(shard.lock);
+            view = shard.gym->snapshot();
+        }
+        summarize(view); // the report itself
+        unordered_set<int> members;
+        members.reserve(view.trainees->size());
+        for (const auto& t : *view.trainees) members.insert(t.id);
+        for (const auto& c : *view.classes) {
+            if (c.enrolledCount() > c.capacity) return false;
+            bool known = true;
+            c.enrolledTrainees.forEach([&](int id) { if (!members.count(id)) known = false; });
+            if (!known) return false;
+        }
+        return true;
+    }
 
-        vector<string> days = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
-        for (const auto& day : days) {
-            cout << "\n--- " << day << " --------------------------------------------------------------------\n";
-            bool foundClassForDay = false;
-            for (const auto& c : classes) {
-                if (c.schedule.rfind(day, 0) == 0) { 
-                    string time = c.schedule.substr(c.schedule.find('-') + 1);
-                    cout << "  " << time << "   " << c.className 
-                         << " (" << c.trainerName << ")"
-                         << "   -   Enrolled: " << c.enrolled << "/" << c.capacity << "\n";
-                    foundClassForDay = true;
+    // After a replay: no class over capacity, nobody both enrolled and waiting,
+    // no waitlist next to a free seat, and the files reload to the same state.
+    bool checkClassInvariants(BranchShard& shard, string& problem) {
+        vector<GymClass> classes = shard.gym->loadClasses();
+        vector<WaitlistRecord> waiting = shard.gym->waitlistSnapshot();
+        map<string, const GymClass*> byName;
+        for (const auto& c : classes) {
+            byName[c.className] = &c;
+            if (c.enrolledCount() > c.capacity) {
+                problem = c.className + " is over capacity";
+                return false;
+            }
+        }
+        for (const auto& w : waiting) {
+            auto it = byName.find(w.className);
+            if (it == byName.end()) {
+                problem = "waitlist for missing class " + w.className;
+                return false;
+            }
+            if (it->second->enrolledCount() < it->second->capacity) {
+                problem = w.className + " has a free seat and a waitlist";
+                return false;
+            }
+            unordered_set<int> seen;
+            for (int id : w.traineeIds) {
+                if (!seen.insert(id).second || it->second->isEnrolled(id)) {
+                    problem = "trainee " + to_string(id) + " is queued twice or both enrolled and waiting for " + w.className;
+                    return false;
                 }
             }
-            if (!foundClassForDay) {
-                cout << "  No classes scheduled for this day.\n";
+        }
+        GymManagement reloaded(shard.dataDir);
+        vector<WaitlistRecord> persisted = reloaded.waitlistSnapshot();
+        bool same = persisted.size() == waiting.size();
+        for (size_t i = 0; same && i < waiting.size(); i++) {
+            same = persisted[i].className == waiting[i].className && persisted[i].traineeIds == waiting[i].traineeIds;
+        }
+        if (!same) {
+            problem = "waitlists.txt does not match the in-memory queues";
+            return false;
+        }
+
+        // The incrementally maintained analytics must equal a fresh rebuild.
+        const OccupancyAnalytics& live = shard.gym->occupancy();
+        OccupancyAnalytics rebuilt;
+        rebuilt.rebuild(classes);
+        for (int day = 0; day < 7; day++) {
+            for (int hour = 0; hour < 24; hour++) {
+                const OccupancyAnalytics::Cell& a = live.cell(day, hour);
+                const OccupancyAnalytics::Cell& b = rebuilt.cell(day, hour);
+                if (a.enrolled != b.enrolled || a.capacity != b.capacity || a.classes != b.classes) {
+                    problem = "occupancy heatmap drifted from the class file";
+                    return false;
+                }
             }
         }
+        vector<OccupancyAnalytics::ClassFill> liveTop = live.fullest(classes.size());
+        vector<OccupancyAnalytics::ClassFill> rebuiltTop = rebuilt.fullest(classes.size());
+        bool sameOrder = liveTop.size() == rebuiltTop.size();
+        for (size_t i = 0; sameOrder && i < liveTop.size(); i++) {
+            sameOrder = liveTop[i].className == rebuiltTop[i].className && liveTop[i].enrolled == rebuiltTop[i].enrolled &&
+                        liveTop[i].capacity == rebuiltTop[i].capacity;
+        }
+        if (!sameOrder) problem = "fullest-class ranking drifted from the class file";
+        return sameOrder;
     }
 
-    void displayDailySchedule() {
-        auto now = chrono::system_clock::now();
-        time_t tt = chrono::system_clock::to_time_t(now);
-        
-        #ifdef _WIN32
-            tm local_tm;
-            localtime_s(&local_tm, &tt);
-        #else
-            tm local_tm = *localtime(&tt);
-        #endif
-
-        vector<string> days = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
-        string today = days[local_tm.tm_wday];
-
-        cout << "\n********************************************************************************\n";
-        cout << "*                        CLASSES FOR TODAY (" << today << ")                             *\n";
-        cout << "********************************************************************************\n";
-        
-        vector<GymClass> classes = loadClasses();
-        bool foundClassToday = false;
+    double percentile(const vector<double>& sorted, double q) {
+        if (sorted.empty()) return 0;
+        size_t rank = static_cast<size_t>(ceil(q * sorted.size()));
+        return sorted[min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+    }
 
-        sort(classes.begin(), classes.end(), [](const GymClass& a, const GymClass& b) {
-            return a.schedule < b.schedule;
-        });
+    // speedup 0 replays as fast as possible; otherwise op i is due at offsetMs / speedup.
+    int replay(const string& path, int threadCount, const string& dataRoot, int hashIterations, double speedup) {
+        Params p;
+        p.hashIterations = hashIterations;
+        PasswordUtils::iterationOverride() = hashIterations; // seeded accounts are already at the configured cost
+        vector<Op> ops;
+        string error;
+        if (!readWorkload(path, p, ops, error)) {
+            cerr << "Error: " << error << "\n";
+            return 1;
+        }
 
-        for (const auto& c : classes) {
-            if (c.schedule.rfind(today, 0) == 0) {
-                 string time = c.schedule.substr(c.schedule.find('-') + 1);
-                 cout << "  " << time << "   " << c.className 
-                      << " (" << c.trainerName << ")"
-                      << "   -   Enrolled: " << c.enrolled << "/" << c.capacity << "\n";
-                 foundClassToday = true;
+        Console::print("Seeding {} branch(es) under {} ...\n", p.branches, dataRoot);
+        vector<unique_ptr<BranchShard>> shards;
+        for (int b = 0; b < p.branches; b++) {
+            auto shard = unique_ptr<BranchShard>(new BranchShard());
+            shard->name = "load" + to_string(b);
+            shard->dataDir = dataRoot + shard->name + "/";
+            error_code ec;
+            filesystem::remove_all(shard->dataDir, ec);
+            filesystem::create_directories(shard->dataDir, ec);
+            if (ec) {
+                cerr << "Error: could not create " << shard->dataDir << ": " << ec.message() << "\n";
+                return 1;
             }
+            shard->gym = unique_ptr<GymManagement>(new GymManagement(shard->dataDir));
+            seedBranch(*shard->gym, p);
+            shard->gym->occupancy(); // start the incremental aggregates so the replay exercises them
+            shards.push_back(move(shard));
         }
-        if (!foundClassToday) {
-            cout << "No classes are scheduled for today. Take a rest day!\n";
-        }
-    }
 
-    void signUpForClass(Trainee& trainee, string className) {
-        if (trainee.membership_package != "Premium") {
-            cout << "Class sign-up is a Premium feature. Please upgrade your membership.\n";
-            return;
+        Console::print("Replaying {} operations on {} thread(s)", ops.size(), threadCount);
+        if (speedup > 0) {
+            double span = ops.empty() ? 0 : ops.back().offsetMs / 1000.0 / speedup;
+            Console::print(" paced at {}x ({:.1f} s of trace time)", speedup, span);
         }
-        vector<GymClass> classes = loadClasses();
-        bool classFound = false;
-        
-        for (auto& c : classes) {
-            if (c.className == className) {
-                classFound = true;
-                
-                if (find(c.enrolledTraineeIds.begin(), c.enrolledTraineeIds.end(), trainee.id) != c.enrolledTraineeIds.end()) {
-                    cout << "You are already enrolled in this class.\n";
-                    return;
-                }
-                
-                if (c.enrolled < c.capacity) {
-                    c.enrolled++;
-                    c.enrolledTraineeIds.push_back(trainee.id);
-                    saveClasses(classes);
-                    cout << trainee.name << " signed up successfully for " << className << "!\n";
-                } else {
-                    cout << "Class is full!\n";
+        cout << " ...\n";
+        atomic<size_t> next(0);
+        vector<map<string, OpStats>> perThread(threadCount);
+        auto started = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threadCount; t++) {
+            workers.emplace_back([&, t]() {
+                map<string, OpStats>& stats = perThread[t];
+                for (size_t i = next++; i < ops.size(); i = next++) {
+                    const Op& op = ops[i];
+                    BranchShard& shard = *shards[op.branch];
+                    auto opStart = chrono::steady_clock::now();
+                    if (speedup > 0) {
+                        // Timed from when the op was due, not when a thread got to it.
+                        auto due = started + chrono::duration_cast<chrono::steady_clock::duration>(
+                                                 chrono::duration<double, milli>(op.offsetMs / speedup));
+                        if (due > opStart) this_thread::sleep_until(due);
+                        opStart = due;
+                    }
+                    bool ok;
+                    if (op.type == "report") {
+                        ok = runReport(shard);
+                    } else {
+                        lock_guard<mutex> guard(shard.lock);
+                        ok = execute(*shard.gym, op);
+                    }
+                    double us = chrono::duration<double, micro>(chrono::steady_clock::now() - opStart).count();
+                    OpStats& s = stats[op.type];
+                    s.latenciesUs.push_back(us);
+                    if (!ok) s.failures++;
                 }
-                return;
-            }
+            });
         }
-        
-        if (!classFound) {
-            cout << "Class not found!\n";
-        }
-    }
-    
-    void viewPaymentStatus() {
-        cout << "\n********************************************************************************\n";
-        cout << "*                            TRAINEE PAYMENT STATUS                            *\n";
-        cout << "********************************************************************************\n";
-        vector<Trainee> trainees = loadTrainees();
-        if (trainees.empty()) {
-            cout << "No trainees registered.\n";
-            return;
+        for (auto& w : workers) w.join();
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+        map<string, OpStats> merged;
+        for (auto& stats : perThread) {
+            for (auto& entry : stats) {
+                OpStats& m = merged[entry.first];
+                m.latenciesUs.insert(m.latenciesUs.end(), entry.second.latenciesUs.begin(), entry.second.latenciesUs.end());
+                m.failures += entry.second.failures;
+            }
         }
-        
-        for (const auto& t : trainees) {
-            cout << "ID: " << t.id << ", Name: " << t.name 
-                 << ", Package: " << t.membership_package << " (" << t.membership_duration_months << " months)"
-                 << ", Status: " << t.payment_status << "\n";
+
+        const string rule(86, '-');
+        Console::print("\n{}\n{:<15}{:>8}{:>9}{:>11}{:>11}{:>11}{:>11}{:>11}\n{}\n", rule, "Operation", "Count", "Rejected",
+                       "Ops/sec", "p50 (us)", "p95 (us)", "p99 (us)", "max (us)", rule);
+        for (auto& entry : merged) {
+            vector<double>& lat = entry.second.latenciesUs;
+            sort(lat.begin(), lat.end());
+            Console::print("{:<15}{:8}{:9}{:11.0f}{:11.0f}{:11.0f}{:11.0f}{:11.0f}\n", entry.first, lat.size(),
+                           entry.second.failures, elapsed > 0 ? lat.size() / elapsed : 0, percentile(lat, 0.50),
+                           percentile(lat, 0.95), percentile(lat, 0.99), lat.back());
         }
-    }
+        Console::print("{}\nTotal: {} ops in {:.2f} s ({:.0f} ops/sec)\n", rule, ops.size(), elapsed,
+                       elapsed > 0 ? ops.size() / elapsed : 0);
 
-    // --- Generic Utility Functions (Mostly unchanged, now called by robust functions) ---
-    void updateTraineeInFile(const Trainee& updatedTrainee) {
-        vector<Trainee> trainees = loadTrainees();
-        for (auto& t : trainees) {
-            if (t.id == updatedTrainee.id) {
-                t = updatedTrainee;
-                break;
+        // Saves land first: the check reopens each branch, whose start-up recovery
+        // would otherwise delete the flusher's half-written .tmp files.
+        bool consistent = true;
+        for (auto& shard : shards) {
+            if (!shard->gym->flushPersistence()) consistent = false;
+        }
+        for (auto& shard : shards) {
+            string problem;
+            if (!checkClassInvariants(*shard, problem)) {
+                Console::print("Invariant violated in {}: {}\n", shard->name, problem);
+                consistent = false;
             }
         }
-        saveTrainees(trainees);
-    }
-    
-    Trainee* searchTraineeByID(int id, vector<Trainee>& trainees) { 
-        for (auto& t : trainees) {
-            if (t.id == id) return &t;
+        size_t waiting = 0;
+        for (auto& shard : shards) {
+            for (const auto& w : shard->gym->waitlistSnapshot()) waiting += w.traineeIds.size();
         }
-        return nullptr;
-    }
-    void displayTrainees() { 
-        cout << "\n********************************************************************************\n";
-        cout << "*                               TRAINEES LIST                               *\n";
-        cout << "********************************************************************************\n";
-        
-        vector<Trainee> trainees = loadTrainees();
-        if (trainees.empty()) {
-            cout << "No trainees enrolled.\n";
-            return;
+        Console::print("Roster/waitlist invariants: {} ({} member(s) still waitlisted)\n", consistent ? "OK" : "FAILED", waiting);
+
+        auto reports = merged.find("report");
+        if (reports != merged.end()) {
+            int torn = reports->second.failures;
+            Console::print("Report snapshots: {} ({} taken during writes, {} inconsistent)\n", torn == 0 ? "OK" : "FAILED",
+                           reports->second.latenciesUs.size(), torn);
+            if (torn > 0) consistent = false;
         }
-        
-        for (const auto& t : trainees) {
-            cout << "ID: " << t.id << ", Name: " << t.name << ", Contact: " << t.contact << ", Membership: " << t.membership_package << "\n";
+
+        AsyncFlusher::Stats saves;
+        for (auto& shard : shards) {
+            AsyncFlusher::Stats st = shard->gym->persistenceStats();
+            saves.submitted += st.submitted;
+            saves.coalesced += st.coalesced;
+            saves.written += st.written;
+            saves.failed += st.failed;
+            saves.blockedSeconds += st.blockedSeconds;
         }
+        Console::print("Background saves: {} submitted, {} coalesced, {} written, {} failed; {:.3f} s waiting for queue space\n",
+                       saves.submitted, saves.coalesced, saves.written, saves.failed, saves.blockedSeconds);
+        return consistent ? 0 : 3;
     }
-        void provideBmiFeedback(float bmi) {
-        cout << "\n--- General Fitness Feedback ---\n";
-        if (bmi < 18.5) {
-            cout << "Category: Underweight\n";
-            cout << "Suggestion: Focus on strength training to build healthy muscle mass. Consider consulting a nutritionist to ensure you're getting enough calories and nutrients.\n";
-        } else if (bmi >= 18.5 && bmi < 25) {
-            cout << "Category: Normal Weight\n";
-            cout << "Suggestion: Great job! Maintain your health with a balanced routine of cardiovascular exercise (like running or cycling) and strength training.\n";
-        } else if (bmi >= 25 && bmi < 30) {
-            cout << "Category: Overweight\n";
-            cout << "Suggestion: A combination of consistent cardiovascular exercise and resistance training is recommended. Seeking professional dietary advice can also be very beneficial.\n";
-        } else { // bmi >= 30
-            cout << "Category: Obese\n";
-            cout << "Suggestion: It's recommended to combine consistent cardiovascular exercise with resistance training. Please consider seeking professional dietary advice for a personalized plan.\n";
-        }
-        cout << "\n** DISCLAIMER **\n";
-        cout << "These suggestions are for informational purposes only and do not constitute professional medical advice. Always consult with a healthcare provider before starting any new fitness or diet program.\n";
+
+    void printUsage() {
+        cout << "Usage:\n"
+             << "  gms --generate-workload <file> [--seed N] [--ops N] [--branches N] [--trainees N]\n"
+             << "                                 [--trainers N] [--classes N] [--zipf S] [--days N]\n"
+             << "  gms --replay <file> [--threads N] [--dir DIR] [--hash-iterations N] [--speedup N]\n";
     }
-    void deleteTrainee(int id) { 
-        vector<Trainee> trainees = loadTrainees();
-        auto it = remove_if(trainees.begin(), trainees.end(), 
-                           [id](const Trainee& t) { return t.id == id; });
-        
-        if (it != trainees.end()) {
-            trainees.erase(it, trainees.end());
-            saveTrainees(trainees);
-            
-            vector<GymClass> classes = loadClasses();
-            for (auto& c : classes) {
-                auto idIt = find(c.enrolledTraineeIds.begin(), c.enrolledTraineeIds.end(), id);
-                if (idIt != c.enrolledTraineeIds.end()) {
-                    c.enrolledTraineeIds.erase(idIt);
-                    c.enrolled--;
+
+    // Handles the load-testing command line; returns the process exit code.
+    int runCommandLine(int argc, char* argv[]) {
+        string command = argv[1];
+        if (argc < 3) {
+            printUsage();
+            return 1;
+        }
+        string path = argv[2];
+        Params p;
+        int threads = static_cast<int>(max(2u, thread::hardware_concurrency()));
+        string dir = "loadtest/";
+        double speedup = 0;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            string value = argv[i + 1];
+            try {
+                if (flag == "--seed") p.seed = stoull(value);
+                else if (flag == "--ops") p.ops = stoi(value);
+                else if (flag == "--branches") p.branches = stoi(value);
+                else if (flag == "--trainees") p.trainees = stoi(value);
+                else if (flag == "--trainers") p.trainers = stoi(value);
+                else if (flag == "--classes") p.classes = stoi(value);
+                else if (flag == "--zipf") p.zipfExponent = stod(value);
+                else if (flag == "--days") p.days = stoi(value);
+                else if (flag == "--threads") threads = stoi(value);
+                else if (flag == "--hash-iterations") p.hashIterations = stoi(value);
+                else if (flag == "--speedup") speedup = stod(value);
+                else if (flag == "--dir") dir = value.empty() || value.back() == '/' ? value : value + "/";
+                else {
+                    cerr << "Unknown option: " << flag << "\n";
+                    printUsage();
+                    return 1;
                 }
+            } catch (const exception&) {
+                cerr << "Invalid value for " << flag << ": " << value << "\n";
+                return 1;
             }
-            saveClasses(classes);
-            
-            cout << "Trainee deleted successfully!\n";
-        } else {
-            cout << "Trainee not found!\n";
         }
-    }
-    void deleteTrainer(int id) { 
-        vector<Trainer> trainers = loadTrainers();
-        string trainerNameToDelete;
-        bool found = false;
+        if (p.ops < 1 || p.branches < 1 || p.trainees < 1 || p.trainers < 1 || p.classes < 1 ||
+            threads < 1 || p.hashIterations < 1 || p.days < 1 || p.zipfExponent < 0 || speedup < 0) {
+            cerr << "All counts must be positive.\n";
+            return 1;
+        }
 
-        for (const auto& t : trainers) {
-            if (t.id == id) {
-                trainerNameToDelete = t.name;
-                found = true;
-                break;
+        if (command == "--generate-workload") {
+            vector<Op> ops = generate(p);
+            if (!writeWorkload(path, p, ops)) {
+                cerr << "Error: could not write " << path << "\n";
+                return 1;
             }
+            map<string, int> counts;
+            for (const auto& op : ops) counts[op.type]++;
+            Console::print("Wrote {} operations (seed {}) to {}:", ops.size(), p.seed, path);
+            for (const auto& c : counts) Console::print(" {}={}", c.first, c.second);
+            cout << "\n";
+            return 0;
         }
+        return replay(path, threads, dir, p.hashIterations, speedup);
+    }
+}
+// =================================================================================
 
-        if (!found) {
-            cout << "Trainer not found!\n";
-            return;
-        }
-        
-        auto it = remove_if(trainers.begin(), trainers.end(), 
-                           [id](const Trainer& t) { return t.id == id; });
-        trainers.erase(it, trainers.end());
-        saveTrainers(trainers);
+// =================================================================================
+// ||                           MAIN PROGRAM LOGIC                                ||
+// =================================================================================
 
-        vector<GymClass> classes = loadClasses();
-        auto classIt = remove_if(classes.begin(), classes.end(),
-                               [&trainerNameToDelete](const GymClass& c) { return c.trainerName == trainerNameToDelete; });
-        if (classIt != classes.end()) {
-            classes.erase(classIt, classes.end());
-            saveClasses(classes);
-            cout << "Trainer and associated classes deleted successfully!\n";
-        } else {
-            cout << "Trainer deleted successfully! (No associated classes found)\n";
-        }
-    }
-    void searchTrainerByID(int id) { 
-        vector<Trainer> trainers = loadTrainers();
-        for (const auto& t : trainers) {
-            if (t.id == id) {
-                cout << "\n********************************************************************************\n";
-                cout << "*                              TRAINER DETAILS                                *\n";
-                cout << "********************************************************************************\n";
-                cout << "ID: " << t.id << "\n";
-                cout << "Name: " << t.name << "\n";
-                cout << "Specialization: " << t.specialization << "\n";
-                cout << "Contact: " << t.contact << "\n";
+void branchMenu(BranchRegistry& registry, string& currentBranch) {
+    while (true) {
+        Console::print("\n------------------------- BRANCHES ({}) -------------------------\n", registry.branchCount());
+        cout << "1. List Branches            5. Combined Payment Report\n";
+        cout << "2. Add Branch               6. Total Revenue\n";
+        cout << "3. Switch Branch            7. Back\n";
+        cout << "4. Global Member Search\n";
+        cout << "------------------------------------------------------------\n";
+        int choice = InputUtils::get_numeric_input<int>("Enter choice (1-7): ", 1, 7);
+
+        if (choice == 1) {
+            for (const auto& name : registry.branchNames()) {
+                Console::print("  {}{}\n", name, name == currentBranch ? "  (current)" : "");
+            }
+        } else if (choice == 2) {
+            string name = InputUtils::get_non_empty_string("Enter new branch name: ");
+            string error;
+            if (registry.addBranch(name, error)) Console::print("Branch '{}' added.\n", name);
+            else Console::print("Error: {}.\n", error);
+        } else if (choice == 3) {
+            string name = InputUtils::get_non_empty_string("Enter branch name: ");
+            if (registry.find(name)) {
+                currentBranch = name;
+                Console::print("Now managing branch '{}'. Please log in again.\n", name);
                 return;
             }
-        }
-        cout << "Trainer not found!\n";
-    }
-    void deleteClass(const string& className) { 
-        vector<GymClass> classes = loadClasses();
-        auto it = remove_if(classes.begin(), classes.end(), 
-                           [className](const GymClass& c) { return c.className == className; });
-        
-        if (it != classes.end()) {
-            classes.erase(it, classes.end());
-            saveClasses(classes);
-            cout << "Class '" << className << "' deleted successfully!\n";
+            cout << "Branch not found!\n";
+        } else if (choice == 4) {
+            string fragment = InputUtils::get_non_empty_string("Enter part of a member name: ");
+            vector<MemberMatch> matches = registry.searchMembers(fragment);
+            if (matches.empty()) cout << "No members found.\n";
+            for (const auto& m : matches) {
+                Console::print("[{}] ID: {}, Name: {}, Contact: {}, Membership: {}\n", m.branch, m.trainee.id,
+                               m.trainee.name, m.trainee.contact, m.trainee.membership_package);
+            }
+        } else if (choice == 5) {
+            int members = 0, paid = 0, due = 0;
+            for (const auto& summary : registry.paymentSummaries()) {
+                Console::print("[{}] Members: {}, Paid: {}, Due: {}, Revenue: ${}\n", summary.branch, summary.members,
+                               summary.paid, summary.due, summary.revenue);
+                for (const auto& t : summary.dueMembers) {
+                    Console::print("    Due -> ID: {}, Name: {}\n", t.id, t.name);
+                }
+                members += summary.members;
+                paid += summary.paid;
+                due += summary.due;
+            }
+            Console::print("All branches: {} members, {} paid, {} due.\n", members, paid, due);
+        } else if (choice == 6) {
+            Console::print("Total membership revenue across {} branch(es): ${}\n", registry.branchCount(),
+                           registry.totalRevenue());
         } else {
-            cout << "Class not found!\n";
-        }
-    }
-    void displayTrainers() { 
-        cout << "\n********************************************************************************\n";
-        cout << "*                               TRAINERS LIST                                *\n";
-        cout << "********************************************************************************\n";
-        
-        vector<Trainer> trainers = loadTrainers();
-        if (trainers.empty()) {
-            cout << "No trainers registered.\n";
             return;
         }
-        
-        for (const auto& t : trainers) {
-            cout << "ID: " << t.id << ", Name: " << t.name << ", Specialization: " << t.specialization << ", Contact: " << t.contact << "\n";
+    }
+}
+
+// `--verify` with no files checks every branch; exits non-zero if any block is damaged.
+int verifyCommandLine(int argc, char* argv[]) {
+    bool allOk = true;
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) {
+            DataFormat::VerifyReport report = DataFormat::verifyFile(argv[i]);
+            DataFormat::printReport(report);
+            if (!report.exists || (report.header.present && !report.ok())) allOk = false;
         }
+        return allOk ? 0 : 2;
     }
-    void updateTrainerInFile(const Trainer& updatedTrainer) { 
-        vector<Trainer> trainers = loadTrainers();
-        for (auto& t : trainers) {
-            if (t.id == updatedTrainer.id) {
-                t = updatedTrainer;
-                break;
+    // Branches are not opened here: that would roll interrupted saves forward,
+    // and a verify run must leave the files exactly as it found them.
+    for (const auto& name : BranchRegistry::listBranches()) {
+        string dir = BranchRegistry::dataDirOf(name);
+        Console::print("[{}]\n", name);
+        if (!GymManagement::verifyFiles(dir)) allOk = false;
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(dir.empty() ? "." : dir, ec)) {
+            string file = entry.path().filename().string();
+            if (file.size() > FileUtils::COMMIT_SUFFIX.size() &&
+                file.compare(file.size() - FileUtils::COMMIT_SUFFIX.size(), string::npos, FileUtils::COMMIT_SUFFIX) == 0) {
+                Console::print("Note: {} records an interrupted save; it is finished the next time the branch is opened.\n", dir + file);
             }
         }
-        saveTrainers(trainers);
     }
-    void displayClassesForTrainer(const Trainer& trainer) { 
-        cout << "\n********************************************************************************\n";
-        cout << "*                      CLASSES TAUGHT BY " << trainer.name << "                     *\n";
-        cout << "********************************************************************************\n";
-        
-        vector<GymClass> classes = loadClasses();
-        bool foundAny = false;
-        
-        for (const auto& c : classes) {
-            if (c.trainerName == trainer.name) {
-                cout << "Class: " << c.className << ", Schedule: " << c.schedule << ", Capacity: " << c.capacity << ", Enrolled: " << c.enrolled << "\n";
-                foundAny = true;
+    return allOk ? 0 : 2;
+}
+
+// gms --import <table> <file.csv> [--branch NAME] [--threads N] [--hash-iterations N] [--rejects FILE]
+// gms --export <table> <file.csv> [--branch NAME]
+int bulkCommandLine(int argc, char* argv[]) {
+    string command = argv[1];
+    BulkCsv::Table table;
+    if (argc < 4 || !BulkCsv::parseTable(argv[2], table)) {
+        cerr << "Usage: gms " << command << " <trainees|trainers|classes> <file.csv> [options]\n";
+        return 1;
+    }
+    string path = argv[3];
+    string branch = BranchRegistry::DEFAULT_BRANCH;
+    BulkCsv::Options options;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        string value = argv[i + 1];
+        try {
+            if (flag == "--branch") branch = value;
+            else if (flag == "--threads") options.threads = stoi(value);
+            else if (flag == "--hash-iterations") options.hashIterations = stoi(value);
+            else if (flag == "--rejects") options.rejectsPath = value;
+            else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
             }
+        } catch (const exception&) {
+            cerr << "Invalid value for " << flag << ": " << value << "\n";
+            return 1;
         }
-        
-        if (!foundAny) cout << "No classes assigned.\n";
     }
-    void displayTraineesForTrainer(const Trainer& trainer) { 
-        cout << "\n********************************************************************************\n";
-        cout << "*                  TRAINEES IN CLASSES TAUGHT BY " << trainer.name << "               *\n";
-        cout << "********************************************************************************\n";
-        
-        vector<GymClass> classes = loadClasses();
-        vector<Trainee> trainees = loadTrainees();
-        bool foundAny = false;
-        
-        for (const auto& c : classes) {
-            if (c.trainerName == trainer.name) {
-                cout << "Class: " << c.className << "\n";
-                if (c.enrolledTraineeIds.empty()) {
-                    cout << "  No trainees enrolled.\n";
-                } else {
-                    for (auto tid : c.enrolledTraineeIds) {
-                        for (const auto& trainee : trainees) {
-                            if (trainee.id == tid) {
-                                cout << "  ID: " << trainee.id << ", Name: " << trainee.name << "\n";
-                                break;
-                            }
-                        }
-                    }
-                }
-                foundAny = true;
-            }
+    if (options.threads < 1) {
+        cerr << "--threads must be positive.\n";
+        return 1;
+    }
+    if (options.hashIterations < PasswordUtils::minimumImportIterations()) {
+        cerr << "--hash-iterations must be at least " << PasswordUtils::minimumImportIterations()
+             << " (accounts below the configured cost are rehashed at their first login).\n";
+        return 1;
+    }
+
+    BranchRegistry registry;
+    BranchShard* shard = registry.find(branch);
+    if (!shard) {
+        cerr << "Branch not found: " << branch << "\n";
+        return 1;
+    }
+    if (command == "--export") {
+        size_t rows = 0;
+        if (!shard->gym->exportCsv(table, path, rows)) {
+            cerr << "Error: could not write " << path << "\n";
+            return 2;
         }
-        
-        if (!foundAny) cout << "No classes assigned, thus no trainees.\n";
+        Console::print("Exported {} row(s) from {} to {}.\n", rows, BulkCsv::tableName(table), path);
+        return 0;
     }
-};
+    BulkCsv::Report report = shard->gym->importCsv(table, path, options);
+    BulkCsv::printReport(table, report);
+    return report.error.empty() ? 0 : 2;
+}
 
-// =================================================================================
-// ||                           MAIN PROGRAM LOGIC                                ||
-// =================================================================================
+int main(int argc, char* argv[]) {
+    Console::install();
+    if (argc > 1) {
+        string command = argv[1];
+        if (command == "--generate-workload" || command == "--replay") return WorkloadTool::runCommandLine(argc, argv);
+        if (command == "--verify") return verifyCommandLine(argc, argv);
+        if (command == "--import" || command == "--export") return bulkCommandLine(argc, argv);
+        WorkloadTool::printUsage();
+        cout << "  gms --verify [data file...]    (default: every branch's data files)\n";
+        cout << "  gms --import <trainees|trainers|classes> <file.csv> [--branch NAME] [--threads N]\n"
+             << "               [--hash-iterations N] [--rejects FILE]\n";
+        cout << "  gms --export <trainees|trainers|classes> <file.csv> [--branch NAME]\n";
+        return 1;
+    }
+
+    BranchRegistry registry;
+    string currentBranch = BranchRegistry::DEFAULT_BRANCH;
 
-int main() {
-    GymManagement gym;
+    cout << Console::bannerText("WELCOME TO THE GYM MANAGEMENT SYSTEM", 1);
 
-    cout << "********************************************************************************\n";
-    cout << "*                                                                              *\n";
-    cout << "*                     WELCOME TO THE GYM MANAGEMENT SYSTEM                     *\n";
-    cout << "*                                                                              *\n";
-    cout << "********************************************************************************\n";
+    if (registry.branchCount() > 1) {
+        cout << "Branches: ";
+        for (const auto& name : registry.branchNames()) Console::print("{} ", name);
+        cout << "\n";
+        while (true) {
+            string name = InputUtils::get_non_empty_string("Select branch: ");
+            if (registry.find(name)) {
+                currentBranch = name;
+                break;
+            }
+            cout << "Branch not found!\n";
+        }
+    }
 
     while (true) {
+        GymManagement& gym = *registry.find(currentBranch)->gym;
+        gym.reportFailedSaves();
+        gym.processExpiredMemberships();
         cout << "\n------------------------------------------------------------------------------\n";
         cout << "| Are you an ADMIN, TRAINER, or TRAINEE? (Enter 'exit' to quit)              |\n";
+        if (registry.branchCount() > 1) {
+            Console::print("| Branch: {:<46}('branch' to switch) |\n", currentBranch);
+        }
         cout << "------------------------------------------------------------------------------\n";
         string userType = InputUtils::get_non_empty_string("Enter your role: ");
         transform(userType.begin(), userType.end(), userType.begin(), ::tolower); // convert to lowercase
 
         if (userType == "exit") break;
 
+        if (userType == "branch") {
+            string name = InputUtils::get_non_empty_string("Enter branch name: ");
+            if (registry.find(name)) currentBranch = name;
+            else cout << "Branch not found!\n";
+            continue;
+        }
+
         if (userType == "admin") {
             if (gym.adminLogin()) {
                 while (true) {
-                    cout << "\n------------------------- ADMIN MENU -------------------------\n";
+                    gym.reportFailedSaves();
+                    gym.processExpiredMemberships();
+                    Console::print("\n------------------------- ADMIN MENU ({}) -------------------------\n", currentBranch);
                     cout << "1. Add Trainer              7. Delete Trainee\n";
                     cout << "2. Add Class                8. Delete Trainer\n";
                     cout << "3. Display Weekly Schedule  9. Delete Class\n";
                     cout << "4. Display Today's Schedule 10. Display All Trainees\n";
                     cout << "5. Search Trainee by ID     11. Display All Trainers\n";
                     cout << "6. Search Trainer by ID     12. View Trainee Payments\n";
-                    cout << "13. Logout\n";
+                    cout << "13. Find Free Trainers      14. Record Check-In\n";
+                    cout << "15. Attendance Report       16. Renew Membership\n";
+                    cout << "17. Bulk Roster Cleanup     18. Compare Class Rosters\n";
+                    cout << "19. Benchmark Password Hash 20. Branches & Reports\n";
+                    cout << "21. Export Change Feed      22. Verify Data Files\n";
+                    cout << "23. Update Class Capacity   24. Occupancy Analytics\n";
+                    cout << "25. Bulk Import / Export    26. Logout\n";
                     cout << "------------------------------------------------------------\n";
-                    int choice = InputUtils::get_numeric_input<int>("Enter choice (1-13): ", 1, 13);
+                    int choice = InputUtils::get_numeric_input<int>("Enter choice (1-26): ", 1, 26);
 
                     if (choice == 1) gym.addTrainer();
                     else if (choice == 2) gym.addClass();
@@ -965,7 +7438,7 @@ int main() {
                         int id = InputUtils::get_numeric_input<int>("Enter Trainee ID to search: ");
                         vector<Trainee> trainees = gym.loadTrainees();
                         Trainee* t = gym.searchTraineeByID(id, trainees);
-                        if (t) cout << "ID: " << t->id << ", Name: " << t->name << ", Contact: " << t->contact << ", Membership: " << t->membership_package << "\n";
+                        if (t) Console::print("ID: {}, Name: {}, Contact: {}, Membership: {}\n", t->id, t->name, t->contact, t->membership_package);
                         else cout << "Trainee not found!\n";
                     }
                     else if (choice == 6) {
@@ -987,14 +7460,32 @@ int main() {
                     else if (choice == 10) gym.displayTrainees();
                     else if (choice == 11) gym.displayTrainers();
                     else if (choice == 12) gym.viewPaymentStatus();
-                    else if (choice == 13) break; // Logout
+                    else if (choice == 13) gym.displayFreeTrainers();
+                    else if (choice == 14) gym.recordCheckIn();
+                    else if (choice == 15) gym.displayAttendanceReport();
+                    else if (choice == 16) gym.renewMembership();
+                    else if (choice == 17) gym.bulkRosterCleanup();
+                    else if (choice == 18) gym.compareClassRosters();
+                    else if (choice == 19) gym.benchmarkPasswordHashing();
+                    else if (choice == 20) {
+                        string before = currentBranch;
+                        branchMenu(registry, currentBranch);
+                        if (currentBranch != before) break; // Re-login on the new branch
+                    }
+                    else if (choice == 21) gym.exportChangeFeed();
+                    else if (choice == 22) gym.verifyDataFiles();
+                    else if (choice == 23) gym.updateClassCapacity();
+                    else if (choice == 24) gym.displayOccupancyAnalytics();
+                    else if (choice == 25) gym.bulkImportExport();
+                    else if (choice == 26) break; // Logout
                 }
             }
         } else if (userType == "trainer") {
             Trainer trainer;
             if (gym.trainerLogin(trainer)) {
                 while (true) {
-                    cout << "\n------------------- TRAINER MENU (" << trainer.name << ") -------------------\n";
+                    gym.reportFailedSaves();
+                    Console::print("\n------------------- TRAINER MENU ({}) -------------------\n", trainer.name);
                     cout << "1. View Profile\n";
                     cout << "2. View Your Classes\n";
                     cout << "3. View Your Trainees\n";
@@ -1003,7 +7494,7 @@ int main() {
                     cout << "------------------------------------------------------------\n";
                     int choice = InputUtils::get_numeric_input<int>("Enter choice (1-5): ", 1, 5);
                     
-                    if (choice == 1) cout << "\nTrainer Profile:\nName: " << trainer.name << "\nSpecialization: " << trainer.specialization << "\nContact: " << trainer.contact << "\n";
+                    if (choice == 1) Console::print("\nTrainer Profile:\nName: {}\nSpecialization: {}\nContact: {}\n", trainer.name, trainer.specialization, trainer.contact);
                     else if (choice == 2) gym.displayClassesForTrainer(trainer);
                     else if (choice == 3) gym.displayTraineesForTrainer(trainer);
                     else if (choice == 4) {
@@ -1028,18 +7519,21 @@ int main() {
                 Trainee trainee;
                 if (gym.traineeLogin(trainee)) {
                     while (true) {
-                        cout << "\n------------------- TRAINEE MENU (" << trainee.name << ") -------------------\n";
+                        gym.reportFailedSaves();
+                        Console::print("\n------------------- TRAINEE MENU ({}) -------------------\n", trainee.name);
                         cout << "1. View Profile              5. Calculate BMI\n";
                         cout << "2. View Today's Schedule     6. Sign Up for a Class\n";
-                        cout << "3. View Weekly Schedule      7. Logout\n";
-                        cout << "4. Update Profile\n";
+                        cout << "3. View Weekly Schedule      7. Check In\n";
+                        cout << "4. Update Profile            8. Withdraw from a Class\n";
+                        cout << "9. Logout\n";
                         cout << "------------------------------------------------------------\n";
-                        int menu_choice = InputUtils::get_numeric_input<int>("Enter choice (1-7): ", 1, 7);
+                        int menu_choice = InputUtils::get_numeric_input<int>("Enter choice (1-9): ", 1, 9);
                         
                         if (menu_choice == 1) {
-                             cout << "\nProfile:\nName: " << trainee.name << "\nContact: " << trainee.contact 
-                                 << "\nMembership: " << trainee.membership_package << " (" << trainee.membership_duration_months << " months)"
-                                 << "\nPayment Status: " << trainee.payment_status << "\n";
+                            Console::print("\nProfile:\nName: {}\nContact: {}\nMembership: {} ({} months)\nPayment Status: {}\nMember Since: {}\nExpires: {}\n",
+                                           trainee.name, trainee.contact, trainee.membership_package, trainee.membership_duration_months,
+                                           trainee.payment_status, ScheduleUtils::formatDate(static_cast<time_t>(trainee.membership_start)),
+                                           ScheduleUtils::formatDate(static_cast<time_t>(trainee.membership_expiry)));
                         }
                         else if (menu_choice == 2) gym.displayDailySchedule();
                         else if (menu_choice == 3) gym.displayWeeklySchedule();
@@ -1053,7 +7547,7 @@ int main() {
                             float bmi = trainee.calculateBMI();
                             if (bmi > 0) {
                             // <<< FIX: Changed round to std::round and added <cmath> header
-                            cout << "Your BMI is: " << std::round(bmi * 100) / 100 << "\n";
+                            Console::print("Your BMI is: {}\n", std::round(bmi * 100) / 100);
                             gym.provideBmiFeedback(bmi); // <<< ADD THIS LINE
                             gym.updateTraineeInFile(trainee);
                             } else{
@@ -1064,7 +7558,12 @@ int main() {
                             string className = InputUtils::get_non_empty_string("Enter the full Class Name to sign up for: ");
                             gym.signUpForClass(trainee, className);
                         }
-                        else if (menu_choice == 7) break; // Logout
+                        else if (menu_choice == 7) gym.checkInTrainee(trainee);
+                        else if (menu_choice == 8) {
+                            string className = InputUtils::get_non_empty_string("Enter the full Class Name to withdraw from: ");
+                            gym.withdrawFromClass(trainee, className);
+                        }
+                        else if (menu_choice == 9) break; // Logout
                     }
                 }
             }
@@ -1075,6 +7574,7 @@ int main() {
         }
     }
     
+    registry.flushAll();
     cout << "\nExiting Gym Management System. Goodbye!\n";
     return 0;
 }
\ No newline at end of file